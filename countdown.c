@@ -0,0 +1,347 @@
+/**
+ * @file countdown.c
+ * @brief Table-driven countdown state machine implementation
+ */
+
+#include "countdown.h"
+#include "sched.h"
+#include "rtc.h"
+#include "systick.h"
+#include "telemetry.h"
+
+/* ==================== State ==================== */
+// Struct-of-arrays: the tick pass walks one dense array of values
+static uint8_t state[COUNTDOWN_CHANNELS];        // timer_state_t
+static mmss_t timer_value[COUNTDOWN_CHANNELS];
+static mmss_t set_value[COUNTDOWN_CHANNELS];
+static mmss_t start_value[COUNTDOWN_CHANNELS];   // timer_value at the last start/resume
+static uint32_t running = 0;                     // Bit per STATE_RUNNING channel
+static sched_task_t tick_task;                   // Released by the RTC second
+static uint32_t last_second;                     // rtc_now() counted down to
+static volatile uint32_t second_ms;              // millis() at the last RTC second
+static countdown_notify_t notify_hook = 0;
+static bool expired = false;                     // CD_EV_EXPIRED raised by an action
+
+/* ==================== Time Helpers ==================== */
+
+// Count down one second, returns false if already at 00:00
+static bool mmss_decrement(mmss_t *t) {
+    static const uint8_t digit_max[4] = { 9, 9, 5, 9 };
+    
+    if(t->word == 0) {
+        return false;
+    }
+    
+    // Borrow from the right, a digit at 0 wraps to its maximum
+    for(int8_t i = 3; i >= 0; i--) {
+        if(t->digit[i] > 0) {
+            t->digit[i]--;
+            break;
+        }
+        t->digit[i] = digit_max[i];
+    }
+    return true;
+}
+
+// Whole value in seconds (multiplies only)
+static uint32_t mmss_seconds(mmss_t t) {
+    return (t.digit[0] * 10 + t.digit[1]) * 60 + t.digit[2] * 10 + t.digit[3];
+}
+
+// Every digit within its BCD range (e.g. read back from flash)
+static bool mmss_valid(mmss_t t) {
+    return t.digit[0] <= 9 && t.digit[1] <= 9 && t.digit[2] <= 5 && t.digit[3] <= 9;
+}
+
+// Add ten seconds, wrapping past 99:59 to 00:10
+static void mmss_add_10s(mmss_t *t) {
+    if(++t->digit[2] < 6) return;
+    t->digit[2] = 0;
+    if(++t->digit[1] < 10) return;
+    t->digit[1] = 0;
+    if(++t->digit[0] < 10) return;
+    *t = (mmss_t)MMSS(0, 0, 1, 0);  // Max 99:59
+}
+
+/* ==================== Actions ==================== */
+typedef void (*action_t)(uint8_t ch, uint32_t arg);
+
+static void act_load(uint8_t ch, uint32_t arg) {
+    (void)arg;
+    timer_value[ch] = set_value[ch];
+}
+
+static void act_add_10s(uint8_t ch, uint32_t arg) {
+    (void)arg;
+    mmss_add_10s(&set_value[ch]);
+    timer_value[ch] = set_value[ch];
+}
+
+static void act_set_time(uint8_t ch, uint32_t arg) {
+    set_value[ch].word = arg;
+    timer_value[ch] = set_value[ch];
+}
+
+// arg = RTC seconds since the last tick, more than 1 after a late run or sleep
+static void act_tick(uint8_t ch, uint32_t arg) {
+    while(arg-- && mmss_decrement(&timer_value[ch]));
+    if(timer_value[ch].word == 0) {
+        expired = true;
+    }
+}
+
+// RTC seconds interrupt, also wakes the CPU from sleep
+static void on_second(void) {
+    second_ms = millis();
+    sched_post(&tick_task);
+}
+
+// The first channel to start restarts the RTC second a full second out,
+// later ones join its phase (first tick after up to 1 s)
+static void enter_running(uint8_t ch) {
+    if(!running) {
+        rtc_restart_second();
+        second_ms = millis();
+        last_second = rtc_now();
+        rtc_on_second(on_second);
+    }
+    running |= 1UL << ch;
+    start_value[ch] = timer_value[ch];
+}
+
+static void exit_running(uint8_t ch) {
+    running &= ~(1UL << ch);
+    if(!running) {
+        rtc_on_second(0);
+        sched_stop(&tick_task);
+    }
+}
+
+static void enter_set(uint8_t ch) {
+    timer_value[ch] = set_value[ch];
+}
+
+/* ==================== Tables ==================== */
+#define SAME  0xFF  // Internal transition: no exit/entry actions
+
+typedef struct {
+    uint8_t next;     // timer_state_t, or SAME
+    action_t action;  // Run before exit/entry, may be NULL
+} transition_t;
+
+// Every [state][event] pair is listed: a missing one would read as
+// { STATE_SET, 0 }, a transition to set mode
+#define IGNORE  { SAME, 0 }
+
+static const transition_t transitions[STATE_COUNT][CD_EV_COUNT] = {
+    [STATE_SET] = {
+        [CD_EV_LOAD]        = { SAME, act_load },
+        [CD_EV_ADD_10S]     = { SAME, act_add_10s },
+        [CD_EV_START_PAUSE] = { STATE_RUNNING, act_load },
+        [CD_EV_RESET]       = { STATE_SET, 0 },
+        [CD_EV_TICK]        = IGNORE,
+        [CD_EV_EXPIRED]     = IGNORE,
+        [CD_EV_START]       = { STATE_RUNNING, act_load },
+        [CD_EV_PAUSE]       = IGNORE,
+        [CD_EV_SET_TIME]    = { SAME, act_set_time },
+    },
+    [STATE_RUNNING] = {
+        [CD_EV_LOAD]        = IGNORE,
+        [CD_EV_ADD_10S]     = IGNORE,
+        [CD_EV_START_PAUSE] = { STATE_PAUSED, 0 },
+        [CD_EV_RESET]       = { STATE_SET, 0 },
+        [CD_EV_TICK]        = { SAME, act_tick },
+        [CD_EV_EXPIRED]     = { STATE_DONE, 0 },
+        [CD_EV_START]       = IGNORE,
+        [CD_EV_PAUSE]       = { STATE_PAUSED, 0 },
+        [CD_EV_SET_TIME]    = IGNORE,
+    },
+    [STATE_PAUSED] = {
+        [CD_EV_LOAD]        = IGNORE,
+        [CD_EV_ADD_10S]     = IGNORE,
+        [CD_EV_START_PAUSE] = { STATE_RUNNING, 0 },
+        [CD_EV_RESET]       = { STATE_SET, 0 },
+        [CD_EV_TICK]        = IGNORE,
+        [CD_EV_EXPIRED]     = IGNORE,
+        [CD_EV_START]       = { STATE_RUNNING, 0 },
+        [CD_EV_PAUSE]       = IGNORE,
+        [CD_EV_SET_TIME]    = IGNORE,
+    },
+    [STATE_DONE] = {
+        [CD_EV_LOAD]        = IGNORE,
+        [CD_EV_ADD_10S]     = IGNORE,
+        [CD_EV_START_PAUSE] = { STATE_SET, 0 },
+        [CD_EV_RESET]       = { STATE_SET, 0 },
+        [CD_EV_TICK]        = IGNORE,
+        [CD_EV_EXPIRED]     = IGNORE,
+        [CD_EV_START]       = IGNORE,
+        [CD_EV_PAUSE]       = IGNORE,
+        [CD_EV_SET_TIME]    = IGNORE,
+    },
+};
+
+static const struct {
+    void (*entry)(uint8_t ch);
+    void (*exit)(uint8_t ch);
+} state_actions[STATE_COUNT] = {
+    [STATE_SET]     = { enter_set, 0 },
+    [STATE_RUNNING] = { enter_running, exit_running },
+    [STATE_PAUSED]  = { 0, 0 },
+    [STATE_DONE]    = { 0, 0 },
+};
+
+/* ==================== Dispatch ==================== */
+
+// One pass over the running channels per second, whatever their number.
+// Elapsed time comes from the RTC, so a late run never loses a second.
+static void tick_task_fn(void *arg) {
+    (void)arg;
+    uint32_t now = rtc_now();
+    uint32_t elapsed = now - last_second;
+    uint32_t pending = running;  // Snapshot: expiring channels leave the mask
+    
+    if(elapsed == 0) {
+        return;
+    }
+    last_second = now;
+    
+    for(uint8_t ch = 0; pending; ch++, pending >>= 1) {
+        if(pending & 1) {
+            countdown_dispatch(ch, CD_EV_TICK, elapsed);
+        }
+    }
+}
+
+bool countdown_dispatch(uint8_t channel, countdown_event_t event, uint32_t arg) {
+    const transition_t *t = &transitions[state[channel]][event];
+    
+    if(t->next == SAME && !t->action) {
+        return false;  // Ignored in this state
+    }
+    
+    if(t->action) {
+        t->action(channel, arg);
+    }
+    if(t->next != SAME) {
+        if(state_actions[state[channel]].exit) state_actions[state[channel]].exit(channel);
+        state[channel] = t->next;
+        if(state_actions[state[channel]].entry) state_actions[state[channel]].entry(channel);
+        telemetry_state(channel, state[channel]);
+    }
+    if(notify_hook) {
+        notify_hook(channel);
+    }
+    
+    // Events raised by actions run after the transition has completed
+    if(expired) {
+        expired = false;
+        countdown_dispatch(channel, CD_EV_EXPIRED, 0);
+    }
+    return true;
+}
+
+/* ==================== Public Functions ==================== */
+
+void countdown_init(uint8_t tick_priority, countdown_notify_t notify) {
+    notify_hook = notify;
+    sched_add(&tick_task, tick_task_fn, 0, tick_priority, SCHED_NO_DEADLINE);
+    
+    for(uint8_t ch = 0; ch < COUNTDOWN_CHANNELS; ch++) {
+        state[ch] = STATE_SET;
+        set_value[ch] = (mmss_t)MMSS(0, 1, 0, 0);  // Default 60 seconds
+        enter_set(ch);
+        if(notify_hook) {
+            notify_hook(ch);
+        }
+    }
+}
+
+void countdown_snapshot(countdown_snapshot_t *out) {
+    for(uint8_t ch = 0; ch < COUNTDOWN_CHANNELS; ch++) {
+        // Running: the resume point, so the ticks leave the snapshot alone
+        mmss_t value = (state[ch] == STATE_RUNNING) ? start_value[ch] : timer_value[ch];
+        
+        out->set_value[ch] = set_value[ch].word;
+        out->timer_value[ch] = value.word;
+        out->state[ch] = state[ch];
+    }
+}
+
+void countdown_restore(const countdown_snapshot_t *in) {
+    for(uint8_t ch = 0; ch < COUNTDOWN_CHANNELS; ch++) {
+        mmss_t set = { .word = in->set_value[ch] };
+        mmss_t value = { .word = in->timer_value[ch] };
+        
+        if(!mmss_valid(set) || !mmss_valid(value) || in->state[ch] >= STATE_COUNT) {
+            continue;
+        }
+        if(state[ch] == STATE_RUNNING) {
+            exit_running(ch);
+        }
+        set_value[ch] = set;
+        timer_value[ch] = value;
+        state[ch] = (in->state[ch] == STATE_RUNNING) ? STATE_PAUSED : in->state[ch];
+        telemetry_state(ch, state[ch]);
+        if(notify_hook) {
+            notify_hook(ch);
+        }
+    }
+}
+
+uint32_t countdown_suspend(rtc_callback_t wake) {
+    uint32_t next = 0xFFFFFFFF;
+    
+    tick_task_fn(0);  // Count any second not yet taken
+    if(!running) {
+        return 0;
+    }
+    for(uint8_t ch = 0; ch < COUNTDOWN_CHANNELS; ch++) {
+        if(running & (1UL << ch)) {
+            uint32_t s = mmss_seconds(timer_value[ch]);
+            if(s < next) {
+                next = s;
+            }
+        }
+    }
+    
+    // The 1 Hz interrupt stays off, the alarm lands on the expiring second
+    rtc_on_second(0);
+    rtc_set_alarm(next, wake);
+    return next;
+}
+
+void countdown_resume(void) {
+    rtc_clear_alarm();
+    if(running) {
+        second_ms = millis();  // Phase unknown after sleep
+        rtc_on_second(on_second);
+        sched_post(&tick_task);  // Catch up on the seconds slept
+    }
+}
+
+timer_state_t countdown_state(uint8_t channel) {
+    return (timer_state_t)state[channel];
+}
+
+mmss_t countdown_value(uint8_t channel) {
+    return timer_value[channel];
+}
+
+mmss_t countdown_value_tenths(uint8_t channel, uint8_t *tenths) {
+    mmss_t value = timer_value[channel];
+    uint32_t k = 0;
+    
+    // Tenths into the current RTC second, the time left is value - k/10
+    if(state[channel] == STATE_RUNNING) {
+        k = (millis() - second_ms) / 100;
+        if(k > 9) {
+            k = 9;  // Tick task not run yet
+        }
+    }
+    if(k && mmss_decrement(&value)) {
+        *tenths = 10 - k;
+    } else {
+        *tenths = 0;
+    }
+    return value;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file countdown.h
+ * @brief Table-driven countdown state machine for N independent channels
+ * @note Buttons, the 1 s tick and console commands are all events fed to
+ *       countdown_dispatch(), which looks up [state][event] in a const table.
+ *       Channel state is kept as struct-of-arrays, one shared tick task
+ *       counts every running channel down in a single pass. Seconds come
+ *       from the RTC, so lateness and sleep never accumulate as drift.
+ */
+
+#ifndef COUNTDOWN_H
+#define COUNTDOWN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rtc.h"
+
+/* ==================== Configuration ==================== */
+// Independent countdowns (max 32, running channels are a bitmask)
+#ifndef COUNTDOWN_CHANNELS
+#define COUNTDOWN_CHANNELS  4
+#endif
+
+/* ==================== States ==================== */
+typedef enum {
+    STATE_SET,
+    STATE_RUNNING,
+    STATE_PAUSED,
+    STATE_DONE,
+    STATE_COUNT
+} timer_state_t;
+
+/* ==================== Events ==================== */
+typedef enum {
+    CD_EV_LOAD,         // Countdown button: show the set time
+    CD_EV_ADD_10S,      // Set button: add ten seconds
+    CD_EV_START_PAUSE,  // Start button: start/pause/resume/acknowledge
+    CD_EV_RESET,        // Reset button: back to set mode
+    CD_EV_TICK,         // One second elapsed
+    CD_EV_EXPIRED,      // Reached 00:00 (raised internally)
+    CD_EV_START,        // Console: start or resume only
+    CD_EV_PAUSE,        // Console: pause only
+    CD_EV_SET_TIME,     // Console: arg = new set time (mmss_t word)
+    CD_EV_COUNT
+} countdown_event_t;
+
+/* ==================== Time Value ==================== */
+// Time as BCD MM:SS digits, digit[0] = tens of minutes. Counting with
+// borrow/carry lets the display use the digits directly, no division.
+typedef union {
+    uint8_t digit[4];
+    uint32_t word;  // For whole-value compare
+} mmss_t;
+
+#define MMSS(m10, m1, s10, s1)  {{ (m10), (m1), (s10), (s1) }}
+
+/* ==================== Types ==================== */
+// Called after a channel's state or time changed (main loop context)
+typedef void (*countdown_notify_t)(uint8_t channel);
+
+// Persistent part of every channel (see countdown_snapshot())
+typedef struct {
+    uint32_t set_value[COUNTDOWN_CHANNELS];    // mmss_t words
+    uint32_t timer_value[COUNTDOWN_CHANNELS];
+    uint8_t state[COUNTDOWN_CHANNELS];         // timer_state_t
+} countdown_snapshot_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Put every channel in STATE_SET and register the shared 1 s tick task
+ * @note Call after rtc_init()
+ * @param tick_priority Scheduler priority of the tick task
+ * @param notify Change hook (may be NULL), called once per channel here
+ */
+void countdown_init(uint8_t tick_priority, countdown_notify_t notify);
+
+/**
+ * @brief Feed one event to a channel's state machine (main loop only)
+ * @param channel Channel 0 to COUNTDOWN_CHANNELS-1
+ * @param event Event
+ * @param arg Event argument (CD_EV_SET_TIME only)
+ * @return false if the event is ignored in the channel's state
+ * @example countdown_dispatch(0, CD_EV_START, 0);
+ */
+bool countdown_dispatch(uint8_t channel, countdown_event_t event, uint32_t arg);
+
+/**
+ * @brief Current state of a channel
+ */
+timer_state_t countdown_state(uint8_t channel);
+
+/**
+ * @brief Time of a channel (counting down, or the set time)
+ */
+mmss_t countdown_value(uint8_t channel);
+
+/**
+ * @brief Time of a channel to a tenth of a second
+ * @param channel Channel
+ * @param tenths Returns the tenths digit 0-9
+ * @return Whole seconds part (rounded up to the tenth like countdown_value())
+ * @note Tenths are interpolated with millis() from the last RTC second and
+ *       read 0 unless the channel is running
+ */
+mmss_t countdown_value_tenths(uint8_t channel, uint8_t *tenths);
+
+/**
+ * @brief Copy every channel's times and state
+ * @param out Snapshot to fill
+ * @note A running channel is recorded with the time it started or resumed
+ *       from: only set times and state changes alter the snapshot, the
+ *       1 s ticks do not (one flash write per change, not per second)
+ */
+void countdown_snapshot(countdown_snapshot_t *out);
+
+/**
+ * @brief Bring channels back from a snapshot (after countdown_init())
+ * @param in Snapshot, e.g. read back from flash
+ * @note A running channel comes back paused at its resume point: time
+ *       without power is not known. Channels with out-of-range digits keep
+ *       their defaults.
+ */
+void countdown_restore(const countdown_snapshot_t *in);
+
+/**
+ * @brief Stop the 1 Hz tick for tickless sleep until the next expiry
+ * @param wake RTC alarm callback, runs when the first running channel expires
+ * @return Seconds until then, 0 if no channel is running (nothing changed)
+ * @note Running channels keep counting on the RTC, call countdown_resume()
+ *       after waking to catch up
+ */
+uint32_t countdown_suspend(rtc_callback_t wake);
+
+/**
+ * @brief Restart the 1 Hz tick after countdown_suspend() and catch up
+ */
+void countdown_resume(void);
+
+#endif // COUNTDOWN_H
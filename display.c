@@ -0,0 +1,79 @@
+/**
+ * @file display.c
+ * @brief Display front end: segment encoding and driver dispatch
+ */
+
+#include "display.h"
+
+/* ==================== Segment Patterns ==================== */
+
+// 7-segment patterns (common cathode: 1=on, 0=off)
+static const uint8_t seg_patterns[10] = {
+    0x3F, // 0: abcdef
+    0x06, // 1: bc
+    0x5B, // 2: abdeg
+    0x4F, // 3: abcdg
+    0x66, // 4: bcfg
+    0x6D, // 5: acdfg
+    0x7D, // 6: acdefg
+    0x07, // 7: abc
+    0x7F, // 8: abcdefg
+    0x6F  // 9: abcdfg
+};
+
+/* ==================== Driver State ==================== */
+static const display_driver_t *driver = &display_direct;
+
+/* ==================== Public Functions ==================== */
+
+void display_init(const display_driver_t *backend) {
+    const uint8_t blank[DISPLAY_DIGITS] = { DISPLAY_BLANK };
+
+    driver = backend;
+    driver->init();
+    driver->write(blank);
+    driver->set_brightness(100);
+}
+
+void display_set_brightness(uint8_t percent) {
+    if(percent > 100) {
+        percent = 100;
+    }
+    driver->set_brightness(percent);
+}
+
+void display_enable(bool on) {
+    driver->enable(on);
+}
+
+uint8_t display_encode_digit(uint8_t value) {
+    return (value <= 9) ? seg_patterns[value] : DISPLAY_BLANK;
+}
+
+void display_write(const uint8_t digits[DISPLAY_DIGITS]) {
+    driver->write(digits);
+}
+
+void display_show_digits(const uint8_t values[DISPLAY_DIGITS], uint8_t dp_mask) {
+    uint8_t digits[DISPLAY_DIGITS];
+
+    for(uint8_t i = 0; i < DISPLAY_DIGITS; i++) {
+        digits[i] = display_encode_digit(values[i]);
+        if(dp_mask & (1 << i)) {
+            digits[i] |= DISPLAY_SEG_DP;
+        }
+    }
+
+    display_write(digits);
+}
+
+void display_show_number(uint16_t number, uint8_t dp_mask) {
+    uint8_t values[DISPLAY_DIGITS];
+
+    values[0] = (number / 1000) % 10;
+    values[1] = (number / 100) % 10;
+    values[2] = (number / 10) % 10;
+    values[3] = number % 10;
+
+    display_show_digits(values, dp_mask);
+}
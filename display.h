@@ -0,0 +1,113 @@
+/**
+ * @file display.h
+ * @brief 4-digit 7-segment display with selectable driver backends
+ * @note The application writes segment patterns, a display_driver_t gets
+ *       them to the digits: display_direct scans GPIO segments with PWM1,
+ *       display_hc595 and display_max7219 shift them out over SSP0
+ */
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ==================== Configuration ==================== */
+// Full-frame refresh rate (each digit is lit DISPLAY_REFRESH_HZ times/second)
+#ifndef DISPLAY_REFRESH_HZ
+#define DISPLAY_REFRESH_HZ  125
+#endif
+
+#define DISPLAY_DIGITS      4
+
+// Longest digit on-time in permille of its slot (100% brightness). The
+// remainder is the dark gap in which the refresh interrupt switches digits.
+#ifndef DISPLAY_DUTY_MAX
+#define DISPLAY_DUTY_MAX    900
+#endif
+
+// Backend used by main (display_direct, display_hc595 or display_max7219)
+#ifndef DISPLAY_DRIVER
+#define DISPLAY_DRIVER      display_direct
+#endif
+
+// Segment pattern bits (common cathode: 1=on, 0=off)
+#define DISPLAY_SEG_DP      0x80
+#define DISPLAY_BLANK       0x00
+
+/* ==================== Driver Interface ==================== */
+// One backend per display hardware, all calls come from the main loop
+typedef struct {
+    void (*init)(void);
+    void (*write)(const uint8_t segments[DISPLAY_DIGITS]);  // [0] = leftmost
+    void (*set_brightness)(uint8_t percent);                // 0-100
+    void (*enable)(bool on);
+} display_driver_t;
+
+// Direct drive: segments on P0.0-P0.7, digit enables PWM1.1-PWM1.4 (P2.0-P2.3)
+extern const display_driver_t display_direct;
+
+// 74HC595 chain on SSP0, one register per digit, OE on PWM1.1 (P2.0)
+extern const display_driver_t display_hc595;
+
+// MAX7219 on SSP0 (DMA), multiplexes the digits itself
+extern const display_driver_t display_max7219;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Start a backend with a blank display at full brightness
+ * @param driver Backend, kept for every later call
+ * @example display_init(&DISPLAY_DRIVER);
+ */
+void display_init(const display_driver_t *driver);
+
+/**
+ * @brief Set brightness
+ * @param percent 0 (off) to 100
+ * @note PWM on-time for display_direct and display_hc595, the 16-step
+ *       intensity register for display_max7219
+ * @example display_set_brightness(40);
+ */
+void display_set_brightness(uint8_t percent);
+
+/**
+ * @brief Switch the digit outputs off or back on
+ * @param on false blanks the display at once, e.g. before Deep-sleep
+ *        (PWM1 stops there and would hold a digit lit)
+ */
+void display_enable(bool on);
+
+/**
+ * @brief Get the segment pattern for a decimal digit
+ * @param value Digit 0-9
+ * @return Segment pattern, DISPLAY_BLANK if value > 9
+ */
+uint8_t display_encode_digit(uint8_t value);
+
+/**
+ * @brief Replace the whole framebuffer in one store
+ * @param digits Segment patterns, digits[0] is the leftmost digit
+ * @note Safe to call while a refresh interrupt or transfer is running
+ */
+void display_write(const uint8_t digits[DISPLAY_DIGITS]);
+
+/**
+ * @brief Show four decimal digits (table lookups only, no division)
+ * @param values Digits 0-9, values[0] is the leftmost (> 9 shows blank)
+ * @param dp_mask Decimal points to light, bit 0 = leftmost digit
+ * @example display_show_digits(bcd, 0x02);  // "MM.SS"
+ */
+void display_show_digits(const uint8_t values[DISPLAY_DIGITS], uint8_t dp_mask);
+
+/**
+ * @brief Show a 4-digit decimal number
+ * @param number Value 0-9999
+ * @param dp_mask Decimal points to light, bit 0 = leftmost digit
+ * @example display_show_number(1234, 0x02);  // "12.34"
+ * @note Splits the number with divisions, prefer display_show_digits()
+ *       on hot paths
+ */
+void display_show_number(uint16_t number, uint8_t dp_mask);
+
+#endif // DISPLAY_H
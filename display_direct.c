@@ -0,0 +1,141 @@
+/**
+ * @file display_direct.c
+ * @brief Direct-drive display backend: PWM1 scans GPIO segment lines
+ * @note Every segment and every digit enable is an MCU pin (12 lines), and
+ *       the refresh interrupt runs DISPLAY_REFRESH_HZ * 4 times a second
+ */
+
+#include "display.h"
+#include "gpio.h"
+#include "pwm.h"
+#include "clock.h"
+#include "profile.h"
+
+/* ==================== Pin Definitions ==================== */
+
+// 7-segment pins (segments a-h)
+#define SEG_A   P0_0
+#define SEG_B   P0_1
+#define SEG_C   P0_2
+#define SEG_D   P0_3
+#define SEG_E   P0_4
+#define SEG_F   P0_5
+#define SEG_G   P0_6
+#define SEG_DP  P0_7  // Decimal point
+
+// Digit enable pins (common cathode/anode) are PWM1.1-PWM1.4 on P2.0-P2.3,
+// each digit is lit for the duty part of its PWM period
+#define DIGIT_PWM_1   1  // Leftmost digit (P2.0)
+#define DIGIT_PWM_2   2
+#define DIGIT_PWM_3   3
+#define DIGIT_PWM_4   4  // Rightmost digit (P2.3)
+
+// Refresh interrupt match, fires after every digit output has gone low
+#define REFRESH_MATCH  5
+
+// Segments are contiguous, so a pattern is one port write
+#define SEG_PORT     GPIO_PORT_OF(SEG_A)
+#define SEG_SHIFT    (SEG_A & 0x1F)
+#define SEG_MASK     (0xFFUL << SEG_SHIFT)    // SEG_A..SEG_DP
+
+/* ==================== Driver State ==================== */
+
+// Pin map: all segments start as outputs driven low
+static const gpio_pin_cfg_t display_pins[] = {
+    GPIO_CFG_OUT(SEG_A, GPIO_LOW),   GPIO_CFG_OUT(SEG_B, GPIO_LOW),
+    GPIO_CFG_OUT(SEG_C, GPIO_LOW),   GPIO_CFG_OUT(SEG_D, GPIO_LOW),
+    GPIO_CFG_OUT(SEG_E, GPIO_LOW),   GPIO_CFG_OUT(SEG_F, GPIO_LOW),
+    GPIO_CFG_OUT(SEG_G, GPIO_LOW),   GPIO_CFG_OUT(SEG_DP, GPIO_LOW)
+};
+
+// Framebuffer: one segment pattern per digit, replaced as a single word
+// so the refresh ISR never sees a half-written number
+static volatile union {
+    uint8_t  digit[DISPLAY_DIGITS];
+    uint32_t word;
+} framebuffer;
+
+static uint8_t scan_pos = 0;          // Digit lit in the next PWM period
+static volatile uint32_t on_ticks;    // Digit on-time per period (brightness)
+static uint8_t brightness = 100;      // Percent, kept to rescale on_ticks
+
+/* ==================== Interrupt Handler ==================== */
+
+/**
+ * @brief Refresh interrupt (PWM1 MR5, DISPLAY_REFRESH_HZ * 4 times/second)
+ * @note Runs while every digit is dark: load the next digit's segments and
+ *       latch its duty, the PWM hardware lights it at the next period start
+ */
+static void display_refresh(uint8_t match) {
+    (void)match;
+    PROFILE_ENTER(display_refresh);
+    uint8_t prev = (scan_pos - 1) & (DISPLAY_DIGITS - 1);
+
+    gpio_port_write_masked(SEG_PORT, SEG_MASK,
+                           (uint32_t)framebuffer.digit[scan_pos] << SEG_SHIFT);
+    pwm_set_ticks(DIGIT_PWM_1 + prev, 0);
+    pwm_set_ticks(DIGIT_PWM_1 + scan_pos, on_ticks);
+
+    scan_pos = (scan_pos + 1) & (DISPLAY_DIGITS - 1);
+    PROFILE_EXIT(display_refresh);
+}
+
+static void direct_set_brightness(uint8_t percent);
+
+// Clock change callback: PWM1 has rescaled its period, redo the on-time
+static void display_clock_changed(uint32_t cpu_hz) {
+    (void)cpu_hz;
+    direct_set_brightness(brightness);
+}
+
+/* ==================== Driver Functions ==================== */
+
+static void direct_init(void) {
+    // Configure segment pins (all off)
+    gpio_config_table(display_pins, sizeof(display_pins) / sizeof(display_pins[0]));
+    framebuffer.word = 0;
+
+    // 1. One PWM period per digit, digit enables driven by PWM1.1-PWM1.4
+    pwm_init(DISPLAY_REFRESH_HZ * DISPLAY_DIGITS);
+    for(uint8_t ch = DIGIT_PWM_1; ch <= DIGIT_PWM_4; ch++) {
+        pwm_enable(ch);
+    }
+    direct_set_brightness(brightness);
+    static bool clock_attached = false;
+    if(!clock_attached) {
+        clock_attached = (clock_attach(display_clock_changed) == 0);  // Retried next init if full
+    }
+
+    // 2. Refresh when the longest allowed on-time has ended
+    pwm_set_ticks(REFRESH_MATCH,
+                  (pwm_period_ticks() * DISPLAY_DUTY_MAX) / PWM_DUTY_MAX);
+    pwm_attach(REFRESH_MATCH, display_refresh);
+}
+
+static void direct_set_brightness(uint8_t percent) {
+    brightness = percent;
+    // Scale into 0..DISPLAY_DUTY_MAX, the refresh interrupt needs the rest
+    on_ticks = (pwm_period_ticks() * DISPLAY_DUTY_MAX / PWM_DUTY_MAX) * percent / 100;
+}
+
+static void direct_enable(bool on) {
+    for(uint8_t ch = DIGIT_PWM_1; ch <= DIGIT_PWM_4; ch++) {
+        if(on) {
+            pwm_enable(ch);
+        } else {
+            pwm_disable(ch, GPIO_LOW);
+        }
+    }
+}
+
+static void direct_write(const uint8_t digits[DISPLAY_DIGITS]) {
+    // Little-endian: digit[0] is the low byte
+    framebuffer.word = (uint32_t)digits[0]
+                     | ((uint32_t)digits[1] << 8)
+                     | ((uint32_t)digits[2] << 16)
+                     | ((uint32_t)digits[3] << 24);
+}
+
+const display_driver_t display_direct = {
+    direct_init, direct_write, direct_set_brightness, direct_enable
+};
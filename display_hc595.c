@@ -0,0 +1,56 @@
+/**
+ * @file display_hc595.c
+ * @brief 74HC595 display backend: one shift register per digit on SSP0
+ * @note Static drive, nothing to refresh: a write is one FIFO burst and
+ *       the registers hold the segments until the next one. Chain the
+ *       595s from the rightmost digit: SSP0 MOSI (P0.18) feeds its SER,
+ *       each QH' feeds the next digit to the left. SCK0 (P0.15) drives
+ *       SRCLK, SSEL0 (P0.16) RCLK, outputs QA-QH are segments a-dp.
+ */
+
+#include "display.h"
+#include "ssp.h"
+#include "gpio.h"
+#include "pwm.h"
+
+/* ==================== Configuration ==================== */
+#define HC595_SSP       SSP_0
+#define HC595_SPI_HZ    4000000    // 20 MHz max at 4.5 V, margin for wiring
+#define HC595_OE_PWM    1          // PWM1.1 on P2.0 to every OE pin
+#define HC595_OE_HZ     1000       // Brightness PWM, well above flicker
+
+/* ==================== Helper Functions ==================== */
+
+// OE is active low: the PWM high time is the dark part of each period
+static void hc595_set_brightness(uint8_t percent) {
+    pwm_set_duty(HC595_OE_PWM, PWM_DUTY_MAX - (uint16_t)percent * (PWM_DUTY_MAX / 100));
+}
+
+/* ==================== Driver Functions ==================== */
+
+static void hc595_init(void) {
+    // Mode 3: the 595 samples on the rising edge, and with CPHA = 1 SSEL
+    // stays low for the whole burst, so its rising edge latches all digits
+    ssp_init(HC595_SSP, HC595_SPI_HZ, 8, SSP_MODE_3);
+
+    pwm_init(HC595_OE_HZ);
+    hc595_set_brightness(0);
+    pwm_enable(HC595_OE_PWM);
+}
+
+static void hc595_write(const uint8_t digits[DISPLAY_DIGITS]) {
+    // The first byte out ends up in the register furthest down the chain
+    ssp_write(HC595_SSP, digits, DISPLAY_DIGITS);
+}
+
+static void hc595_enable(bool on) {
+    if(on) {
+        pwm_enable(HC595_OE_PWM);
+    } else {
+        pwm_disable(HC595_OE_PWM, GPIO_HIGH);  // OE high = dark, never low in between
+    }
+}
+
+const display_driver_t display_hc595 = {
+    hc595_init, hc595_write, hc595_set_brightness, hc595_enable
+};
@@ -0,0 +1,132 @@
+/**
+ * @file display_max7219.c
+ * @brief MAX7219 display backend on SSP0 with DMA
+ * @note The chip scans the digits itself, so the CPU only sends a frame
+ *       when the picture changes: the intensity, shutdown and digit
+ *       registers go out as one DMA burst of 16-bit words. SSP0 SCK
+ *       (P0.15) drives CLK, SSEL (P0.16) LOAD, MOSI (P0.18) DIN. Digit 0
+ *       (leftmost) is the chip's DIG0, segments a-g and dp are wired to
+ *       SEG A-G and DP.
+ */
+
+#include "display.h"
+#include "ssp.h"
+#include <lpc17xx.h>
+
+/* ==================== Configuration ==================== */
+#define MAX7219_SSP     SSP_0
+#define MAX7219_SPI_HZ  5000000    // 10 MHz max
+
+/* ==================== Registers ==================== */
+#define REG_DIGIT0      0x01       // DIG0-DIG7 at 0x01-0x08
+#define REG_DECODE      0x09       // 0 = raw segments on every digit
+#define REG_INTENSITY   0x0A       // 0-15, duty (2n+1)/32
+#define REG_SCAN_LIMIT  0x0B       // Digits scanned - 1
+#define REG_SHUTDOWN    0x0C       // 0 = shutdown, 1 = normal operation
+#define REG_TEST        0x0F
+
+#define INTENSITY_MAX   15
+#define WORD(reg, data) ((uint16_t)(((reg) << 8) | (data)))
+
+/* ==================== Driver State ==================== */
+// Register image: intensity, shutdown, then one word per digit
+enum { FRAME_INTENSITY, FRAME_SHUTDOWN, FRAME_DIGIT0, FRAME_WORDS = FRAME_DIGIT0 + DISPLAY_DIGITS };
+
+static uint16_t image[FRAME_WORDS];         // Latest state, written by the main loop
+static uint16_t tx[FRAME_WORDS];            // DMA source, stable while queued
+static volatile bool pending = false;       // image changed during a burst
+static void burst_done(ssp_xfer_t *xfer);
+static ssp_xfer_t burst = {
+    .tx = tx, .count = FRAME_WORDS, .flags = SSP_XFER_DMA, .callback = burst_done
+};
+static uint8_t intensity = INTENSITY_MAX;
+static bool enabled = true;
+
+/* ==================== Helper Functions ==================== */
+
+// Pattern bits a-g (0-6) and dp (7) to register bits D6-D0 and D7
+static uint8_t remap(uint8_t segments) {
+    uint8_t out = segments & DISPLAY_SEG_DP;
+
+    for(uint8_t i = 0; i < 7; i++) {
+        if(segments & (1 << i)) {
+            out |= 1 << (6 - i);
+        }
+    }
+    return out;
+}
+
+static void start_burst(void) {
+    for(uint8_t i = 0; i < FRAME_WORDS; i++) {
+        tx[i] = image[i];
+    }
+    ssp_submit(MAX7219_SSP, &burst);
+}
+
+// Burst done (DMA interrupt): resend if the image changed meanwhile
+static void burst_done(ssp_xfer_t *xfer) {
+    (void)xfer;
+    if(pending) {
+        pending = false;
+        start_burst();
+    }
+}
+
+// Send the image now, or after the burst in progress
+static void update(void) {
+    uint16_t shutdown = WORD(REG_SHUTDOWN, (enabled && intensity != 0xFF) ? 1 : 0);
+
+    __disable_irq();
+    image[FRAME_SHUTDOWN] = shutdown;
+    image[FRAME_INTENSITY] = WORD(REG_INTENSITY, (intensity == 0xFF) ? 0 : intensity);
+    if(ssp_pending(&burst)) {
+        pending = true;
+    } else {
+        start_burst();
+    }
+    __enable_irq();
+}
+
+/* ==================== Driver Functions ==================== */
+
+static void max7219_init(void) {
+    // Mode 0 with 16-bit frames: CPHA = 0 raises SSEL after every word,
+    // and that rising edge on LOAD latches it
+    const uint16_t setup[] = {
+        WORD(REG_TEST, 0),
+        WORD(REG_DECODE, 0),
+        WORD(REG_SCAN_LIMIT, DISPLAY_DIGITS - 1),
+    };
+
+    ssp_init(MAX7219_SSP, MAX7219_SPI_HZ, 16, SSP_MODE_0);
+    ssp_write(MAX7219_SSP, setup, sizeof(setup) / sizeof(setup[0]));
+
+    for(uint8_t i = 0; i < DISPLAY_DIGITS; i++) {
+        image[FRAME_DIGIT0 + i] = WORD(REG_DIGIT0 + i, 0);
+    }
+    update();
+}
+
+static void max7219_write(const uint8_t digits[DISPLAY_DIGITS]) {
+    // Word stores only: a burst copying the image meanwhile sees each
+    // digit either old or new, and pending resends the rest
+    for(uint8_t i = 0; i < DISPLAY_DIGITS; i++) {
+        image[FRAME_DIGIT0 + i] = WORD(REG_DIGIT0 + i, remap(digits[i]));
+    }
+    update();
+}
+
+// 0% uses shutdown, the lowest intensity step still lights the segments
+static void max7219_set_brightness(uint8_t percent) {
+    intensity = (percent == 0) ? 0xFF : (uint8_t)((percent * INTENSITY_MAX + 50) / 100);
+    update();
+}
+
+static void max7219_enable(bool on) {
+    enabled = on;
+    update();
+}
+
+const display_driver_t display_max7219 = {
+    max7219_init, max7219_write, max7219_set_brightness, max7219_enable
+};
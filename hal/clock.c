@@ -0,0 +1,222 @@
+/**
+ * @file clock.c
+ * @brief Core clock (PLL0) and peripheral clock HAL implementation
+ */
+
+#include "clock.h"
+#include <lpc17xx.h>
+
+/* ==================== Register Bits ==================== */
+#define PLL0CON_PLLE    (1 << 0)     // Enable
+#define PLL0CON_PLLC    (1 << 1)     // Connect
+#define PLL0STAT_MSEL   0x7FFF       // M - 1
+#define PLL0STAT_NSEL   (0xFF << 16) // N - 1
+#define PLL0STAT_PLLE   (1 << 24)
+#define PLL0STAT_PLLC   (1 << 25)
+#define PLL0STAT_PLOCK  (1 << 26)
+#define SCS_OSCEN       (1 << 5)     // Main oscillator enable
+#define SCS_OSCSTAT     (1 << 6)     // Main oscillator ready
+#define CLKSRC_IRC      0
+#define CLKSRC_MAIN     1
+#define CLKSRC_RTC      2
+#define FLASHCFG_TIM    (0xF << 12)  // Flash access time field
+#define FLASHCFG_CYCLES(n)  ((uint32_t)((n) - 1) << 12)
+#define PCON_PM_MASK    3            // 00 + SLEEPDEEP = Deep-sleep
+
+// PLL0 limits (UM10360 "PLL0 frequency calculation")
+#define FCCO_MIN        275000000UL
+#define FCCO_MAX        550000000UL
+#define PLL_M_MIN       6
+#define PLL_M_MAX       512
+#define PLL_N_MAX       32
+
+/* ==================== Driver State ==================== */
+static uint32_t cpu_hz = 0;  // 0 until first read from the registers
+static clock_callback_t clock_callbacks[CLOCK_MAX_CALLBACKS];
+static uint8_t callback_count = 0;
+
+/* ==================== Helper Functions ==================== */
+
+static void pll0_feed(void) {
+    LPC_SC->PLL0FEED = 0xAA;
+    LPC_SC->PLL0FEED = 0x55;
+}
+
+// Current CCLK from CLKSRCSEL / PLL0 / CCLKCFG (e.g. as left by startup code)
+static uint32_t read_cclk(void) {
+    uint32_t src;
+
+    switch(LPC_SC->CLKSRCSEL & 3) {
+        case CLKSRC_MAIN: src = CLOCK_MAIN_OSC_HZ; break;
+        case CLKSRC_RTC:  src = CLOCK_RTC_OSC_HZ; break;
+        default:          src = CLOCK_IRC_HZ; break;
+    }
+
+    uint32_t stat = LPC_SC->PLL0STAT;
+    if((stat & (PLL0STAT_PLLE | PLL0STAT_PLLC)) == (PLL0STAT_PLLE | PLL0STAT_PLLC)) {
+        // Fcco = 2 * M * Fin / N
+        uint32_t m = (stat & PLL0STAT_MSEL) + 1;
+        uint32_t n = ((stat & PLL0STAT_NSEL) >> 16) + 1;
+        src = (uint32_t)(((uint64_t)src * 2 * m) / n);
+    }
+
+    return src / ((LPC_SC->CCLKCFG & 0xFF) + 1);
+}
+
+// Flash access cycles: one per started 20 MHz
+static void set_flash_timing(uint32_t hz) {
+    uint32_t cycles = (hz - 1) / 20000000 + 1;
+
+    LPC_SC->FLASHCFG = (LPC_SC->FLASHCFG & ~FLASHCFG_TIM) | FLASHCFG_CYCLES(cycles);
+}
+
+/**
+ * Find PLL0 settings giving exactly hz: hz = 2 * M * Fin / (N * div)
+ * Smallest CCLK divider first keeps Fcco (and PLL power) low.
+ */
+static uint8_t find_pll_config(uint32_t hz, uint16_t *m_out, uint8_t *n_out, uint16_t *div_out) {
+    for(uint32_t div = 2; div <= 256; div++) {
+        uint64_t fcco = (uint64_t)hz * div;
+
+        if(fcco < FCCO_MIN) continue;
+        if(fcco > FCCO_MAX) break;
+
+        for(uint32_t n = 1; n <= PLL_N_MAX; n++) {
+            uint64_t m2 = fcco * n;  // = 2 * M * Fin
+            if(m2 % (2 * CLOCK_MAIN_OSC_HZ)) continue;
+
+            uint64_t m = m2 / (2 * CLOCK_MAIN_OSC_HZ);
+            if(m >= PLL_M_MIN && m <= PLL_M_MAX) {
+                *m_out = (uint16_t)m;
+                *n_out = (uint8_t)n;
+                *div_out = (uint16_t)div;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* ==================== Public Functions ==================== */
+
+uint32_t clock_set_cpu(uint32_t hz) {
+    uint16_t m = 0, div = 0;
+    uint8_t n = 0;
+    uint8_t use_pll;
+
+    if(hz == 0 || hz > CLOCK_MAX_HZ) {
+        return 0;
+    }
+
+    // Oscillator fractions need no PLL (lowest power)
+    if(CLOCK_MAIN_OSC_HZ % hz == 0 && CLOCK_MAIN_OSC_HZ / hz <= 256) {
+        use_pll = 0;
+        div = CLOCK_MAIN_OSC_HZ / hz;
+    } else if(find_pll_config(hz, &m, &n, &div)) {
+        use_pll = 1;
+    } else {
+        return 0;
+    }
+
+    uint32_t old_hz = clock_get_cpu();
+    uint32_t primask = __get_PRIMASK();  // Masked already from deep sleep
+
+    __disable_irq();
+
+    // Flash must be slow enough for the faster of the two clocks
+    if(hz > old_hz) {
+        set_flash_timing(hz);
+    }
+
+    // 1. Run straight from the clock source while PLL0 is changed
+    if(LPC_SC->PLL0STAT & PLL0STAT_PLLC) {
+        LPC_SC->PLL0CON = PLL0CON_PLLE;
+        pll0_feed();
+    }
+    LPC_SC->PLL0CON = 0;
+    pll0_feed();
+
+    // 2. Main oscillator as the source
+    if(!(LPC_SC->SCS & SCS_OSCSTAT)) {
+        LPC_SC->SCS |= SCS_OSCEN;
+        while(!(LPC_SC->SCS & SCS_OSCSTAT));
+    }
+    LPC_SC->CLKSRCSEL = CLKSRC_MAIN;
+
+    // 3. Either lock and connect PLL0, or divide the oscillator directly
+    if(use_pll) {
+        LPC_SC->PLL0CFG = (uint32_t)(m - 1) | ((uint32_t)(n - 1) << 16);
+        pll0_feed();
+        LPC_SC->PLL0CON = PLL0CON_PLLE;
+        pll0_feed();
+        while(!(LPC_SC->PLL0STAT & PLL0STAT_PLOCK));
+
+        LPC_SC->CCLKCFG = div - 1;
+        LPC_SC->PLL0CON = PLL0CON_PLLE | PLL0CON_PLLC;
+        pll0_feed();
+        while(!(LPC_SC->PLL0STAT & PLL0STAT_PLLC));
+    } else {
+        LPC_SC->CCLKCFG = div - 1;
+    }
+
+    if(hz <= old_hz) {
+        set_flash_timing(hz);
+    }
+
+    // 4. Let dependent drivers (SysTick, UART, timers) rescale
+    cpu_hz = hz;
+    for(uint8_t i = 0; i < callback_count; i++) {
+        clock_callbacks[i](hz);
+    }
+
+    __set_PRIMASK(primask);
+    return hz;
+}
+
+uint32_t clock_get_cpu(void) {
+    if(cpu_hz == 0) {
+        cpu_hz = read_cclk();
+    }
+    return cpu_hz;
+}
+
+void clock_set_pclk(clock_periph_t periph, uint8_t div) {
+    // PCLKSEL encoding: 00 = /4, 01 = /1, 10 = /2, 11 = /8
+    uint32_t sel = (div == 1) ? 1 : (div == 2) ? 2 : (div == 8) ? 3 : 0;
+    uint32_t shift = (periph & 15) * 2;
+
+    if(periph < 16) {
+        LPC_SC->PCLKSEL0 = (LPC_SC->PCLKSEL0 & ~(3UL << shift)) | (sel << shift);
+    } else {
+        LPC_SC->PCLKSEL1 = (LPC_SC->PCLKSEL1 & ~(3UL << shift)) | (sel << shift);
+    }
+}
+
+uint32_t clock_get_pclk(clock_periph_t periph) {
+    static const uint8_t pclk_div[4] = { 4, 1, 2, 8 };
+    uint32_t reg = (periph < 16) ? LPC_SC->PCLKSEL0 : LPC_SC->PCLKSEL1;
+    uint32_t sel = (reg >> ((periph & 15) * 2)) & 3;
+
+    return clock_get_cpu() / pclk_div[sel];
+}
+
+int clock_attach(clock_callback_t callback) {
+    if(callback_count >= CLOCK_MAX_CALLBACKS) {
+        return -1;
+    }
+    clock_callbacks[callback_count++] = callback;
+    return 0;
+}
+
+void clock_deep_sleep(void) {
+    uint32_t hz = clock_get_cpu();
+
+    LPC_SC->PCON &= ~PCON_PM_MASK;
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    __DSB();
+    __WFI();
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    // Woke on the IRC with PLL0 disconnected: bring the clock back
+    clock_set_cpu(hz);
+}
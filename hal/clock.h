@@ -0,0 +1,117 @@
+/**
+ * @file clock.h
+ * @brief Core clock (PLL0) and peripheral clock HAL for LPC1768
+ * @note Single source of truth for CCLK/PCLK, with change notification
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+/* ==================== Configuration ==================== */
+// Main oscillator (crystal) frequency of the board
+#ifndef CLOCK_MAIN_OSC_HZ
+#define CLOCK_MAIN_OSC_HZ   12000000UL
+#endif
+
+#define CLOCK_IRC_HZ        4000000UL    // Internal RC oscillator
+#define CLOCK_RTC_OSC_HZ    32768UL
+#define CLOCK_MAX_HZ        100000000UL  // LPC1768 maximum CCLK
+
+// Maximum number of registered frequency change callbacks (systick, uart,
+// timer, pwm, ssp and display_direct register one each, leave headroom)
+#ifndef CLOCK_MAX_CALLBACKS
+#define CLOCK_MAX_CALLBACKS 8
+#endif
+
+/* ==================== Peripheral Clocks ==================== */
+// PCLKSEL field index: PCLKSEL0 for 0-15, PCLKSEL1 for 16-31
+typedef enum {
+    CLOCK_PCLK_WDT     = 0,
+    CLOCK_PCLK_TIMER0  = 1,
+    CLOCK_PCLK_TIMER1  = 2,
+    CLOCK_PCLK_UART0   = 3,
+    CLOCK_PCLK_UART1   = 4,
+    CLOCK_PCLK_PWM1    = 6,
+    CLOCK_PCLK_I2C0    = 7,
+    CLOCK_PCLK_SPI     = 8,
+    CLOCK_PCLK_SSP1    = 10,
+    CLOCK_PCLK_DAC     = 11,
+    CLOCK_PCLK_ADC     = 12,
+    CLOCK_PCLK_CAN1    = 13,
+    CLOCK_PCLK_CAN2    = 14,
+    CLOCK_PCLK_ACF     = 15,
+    CLOCK_PCLK_QEI     = 16,
+    CLOCK_PCLK_GPIOINT = 17,
+    CLOCK_PCLK_PCB     = 18,
+    CLOCK_PCLK_I2C1    = 19,
+    CLOCK_PCLK_SSP0    = 21,
+    CLOCK_PCLK_TIMER2  = 22,
+    CLOCK_PCLK_TIMER3  = 23,
+    CLOCK_PCLK_UART2   = 24,
+    CLOCK_PCLK_UART3   = 25,
+    CLOCK_PCLK_I2C2    = 26,
+    CLOCK_PCLK_I2S     = 27,
+    CLOCK_PCLK_RIT     = 29,
+    CLOCK_PCLK_SYSCON  = 30,
+    CLOCK_PCLK_MC      = 31
+} clock_periph_t;
+
+/* ==================== Types ==================== */
+// Called after every CPU frequency change, with interrupts disabled
+typedef void (*clock_callback_t)(uint32_t cpu_hz);
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Switch the CPU clock
+ * @param hz Target frequency, up to CLOCK_MAX_HZ
+ * @return Frequency set, 0 if hz cannot be made exactly (clock unchanged)
+ * @note Integer fractions of the main oscillator run with PLL0 off, other
+ *       rates use PLL0. Flash wait states follow the frequency. Callbacks
+ *       run before interrupts are re-enabled, bytes on the wire may be lost.
+ * @example clock_set_cpu(100000000);  // Burst
+ * @example clock_set_cpu(12000000);   // Idle counting, PLL0 off
+ */
+uint32_t clock_set_cpu(uint32_t hz);
+
+/**
+ * @brief Get the current CPU clock
+ * @return CCLK in Hz (read from PLL0/CCLKCFG on first use)
+ */
+uint32_t clock_get_cpu(void);
+
+/**
+ * @brief Set a peripheral clock divider
+ * @param periph Peripheral
+ * @param div CCLK divider: 1, 2, 4 or 8
+ * @note Change it only while the peripheral is disabled
+ */
+void clock_set_pclk(clock_periph_t periph, uint8_t div);
+
+/**
+ * @brief Get a peripheral clock
+ * @param periph Peripheral
+ * @return PCLK in Hz
+ */
+uint32_t clock_get_pclk(clock_periph_t periph);
+
+/**
+ * @brief Register a function to run after every CPU frequency change
+ * @param callback Function to call
+ * @return 0 on success, -1 if CLOCK_MAX_CALLBACKS are already registered
+ * @example clock_attach(systick_clock_changed);
+ */
+int clock_attach(clock_callback_t callback);
+
+/**
+ * @brief Enter Deep-sleep until an interrupt that can wake it (e.g., RTC)
+ * @note SysTick, PLL0 and the main oscillator stop, only the RTC keeps
+ *       time. CCLK returns on the IRC and is restored with clock_set_cpu()
+ *       on wake, so the callbacks run and interrupts end up enabled.
+ *       Flush the UARTs first (uart_tx_idle()).
+ */
+void clock_deep_sleep(void);
+
+#endif // CLOCK_H
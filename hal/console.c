@@ -0,0 +1,120 @@
+/**
+ * @file console.c
+ * @brief Non-blocking line console implementation
+ */
+
+#include "console.h"
+#include <stdbool.h>
+
+static uart_num_t console_port;
+static const console_cmd_t *cmd_table;
+static size_t cmd_count;
+static char line[CONSOLE_LINE_MAX + 1];
+static uint8_t line_len = 0;
+static bool overflow = false;  // Discarding the rest of a too-long line
+
+/* ==================== Helper Functions ==================== */
+
+static bool str_equal(const char *a, const char *b) {
+    while(*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// Split in place on spaces/tabs
+static uint8_t split_words(char *s, char *argv[]) {
+    uint8_t argc = 0;
+
+    while(*s) {
+        while(*s == ' ' || *s == '\t') *s++ = '\0';
+        if(!*s) break;
+        if(argc == CONSOLE_MAX_ARGS) return argc + 1;  // Too many
+        argv[argc++] = s;
+        while(*s && *s != ' ' && *s != '\t') s++;
+    }
+    return argc;
+}
+
+static void print_help(void) {
+    uart_puts(console_port, "help\r\n");
+    for(size_t i = 0; i < cmd_count; i++) {
+        uart_printf(console_port, "%-8s %s\r\n", cmd_table[i].name, cmd_table[i].help);
+    }
+}
+
+static void execute_line(void) {
+    char *argv[CONSOLE_MAX_ARGS];
+    uint8_t argc = split_words(line, argv);
+
+    if(argc == 0) {
+        return;  // Empty line, no reply
+    }
+    if(argc > CONSOLE_MAX_ARGS) {
+        uart_puts(console_port, "ERR too many arguments\r\n");
+        return;
+    }
+    if(str_equal(argv[0], "help")) {
+        print_help();
+        uart_puts(console_port, "OK\r\n");
+        return;
+    }
+
+    for(size_t i = 0; i < cmd_count; i++) {
+        if(str_equal(argv[0], cmd_table[i].name)) {
+            int rc = cmd_table[i].handler(argc, argv);
+            uart_puts(console_port, rc == 0 ? "OK\r\n" : "ERR\r\n");
+            return;
+        }
+    }
+    uart_puts(console_port, "ERR unknown command\r\n");
+}
+
+/* ==================== Public Functions ==================== */
+
+void console_init(uart_num_t uart, const console_cmd_t *commands, size_t count) {
+    console_port = uart;
+    cmd_table = commands;
+    cmd_count = count;
+    line_len = 0;
+    overflow = false;
+}
+
+void console_poll(void) {
+    char chunk[16];
+    size_t n;
+
+    while((n = uart_read(console_port, chunk, sizeof(chunk))) > 0) {
+        for(size_t i = 0; i < n; i++) {
+            char c = chunk[i];
+
+            if(c == '\r' || c == '\n') {
+                if(overflow) {
+                    uart_puts(console_port, "ERR line too long\r\n");
+                } else if(line_len > 0) {
+                    line[line_len] = '\0';
+#if CONSOLE_ECHO
+                    uart_puts(console_port, "\r\n");
+#endif
+                    execute_line();
+                }
+                line_len = 0;
+                overflow = false;
+            } else if(c == '\b' || c == 0x7F) {
+                if(line_len > 0) line_len--;
+            } else if(line_len < CONSOLE_LINE_MAX) {
+                line[line_len++] = c;
+#if CONSOLE_ECHO
+                uart_putc(console_port, c);
+#endif
+            } else {
+                overflow = true;
+            }
+        }
+    }
+}
+
+uart_num_t console_uart(void) {
+    return console_port;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file console.h
+ * @brief Non-blocking line console on a UART
+ * @note RX bytes are consumed incrementally into a fixed line buffer and
+ *       each complete line is dispatched from a const command table.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "uart.h"
+
+/* ==================== Configuration ==================== */
+// Longest accepted line (without terminator)
+#ifndef CONSOLE_LINE_MAX
+#define CONSOLE_LINE_MAX  48
+#endif
+
+// Maximum words per line, including the command name
+#ifndef CONSOLE_MAX_ARGS
+#define CONSOLE_MAX_ARGS  4
+#endif
+
+// Echo received characters (off for fixtures driving the port)
+#ifndef CONSOLE_ECHO
+#define CONSOLE_ECHO      0
+#endif
+
+/* ==================== Types ==================== */
+// Return 0 for "OK", anything else for "ERR"
+typedef int (*console_handler_t)(uint8_t argc, char *argv[]);
+
+typedef struct {
+    const char *name;
+    const char *help;          // One-line usage, shown by "help"
+    console_handler_t handler;
+} console_cmd_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Attach the console to a UART (already initialized)
+ * @param uart UART number
+ * @param commands Command table (static const storage)
+ * @param count Number of commands
+ * @note "help" is built in and lists the table
+ * @example console_init(UART_2, commands, sizeof(commands) / sizeof(commands[0]));
+ */
+void console_init(uart_num_t uart, const console_cmd_t *commands, size_t count);
+
+/**
+ * @brief Consume the bytes waiting in the RX buffer (never blocks)
+ * @note Call from the main loop, e.g. on EVENT_UART_RX. Every line is
+ *       answered with "OK" or "ERR <reason>" after the handler's output.
+ */
+void console_poll(void);
+
+/**
+ * @brief UART the console is attached to (for handler output)
+ */
+uart_num_t console_uart(void);
+
+#endif // CONSOLE_H
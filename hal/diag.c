@@ -0,0 +1,100 @@
+/**
+ * @file diag.c
+ * @brief Stack and interrupt-latency monitor implementation
+ */
+
+#include "diag.h"
+#include <lpc17xx.h>
+
+/* ==================== Driver State ==================== */
+extern uint32_t DIAG_STACK_LIMIT[];
+extern uint32_t DIAG_STACK_TOP[];
+
+#define PAINT_MARGIN    16          // Words left alone below the live SP
+
+#if DIAG_ENABLE
+static const char *const irq_names[DIAG_IRQ_COUNT] = {
+    "systick", "pwm1", "timer0", "timer1", "timer2", "timer3",
+    "uart0", "uart1", "uart2", "uart3", "ssp0", "ssp1",
+    "dma", "eint3", "rtc"
+};
+#endif
+
+// Written by each handler only: one writer per entry
+static diag_irq_stats_t irq_stats[DIAG_IRQ_COUNT];
+
+/* ==================== Public Functions ==================== */
+
+void diag_init(void) {
+    uint32_t *p = DIAG_STACK_LIMIT;
+    uint32_t *end = (uint32_t *)(uintptr_t)__get_MSP() - PAINT_MARGIN;
+
+    while(p < end) {
+        *p++ = DIAG_STACK_PAINT;
+    }
+
+    for(uint8_t i = 0; i < DIAG_IRQ_COUNT; i++) {
+        irq_stats[i].count = 0;
+        irq_stats[i].max_latency = DIAG_NO_LATENCY;
+        irq_stats[i].max_run = 0;
+    }
+}
+
+size_t diag_stack_used(void) {
+    const uint32_t *p = DIAG_STACK_LIMIT;
+
+    while(p < DIAG_STACK_TOP && *p == DIAG_STACK_PAINT) {
+        p++;
+    }
+    return (size_t)(DIAG_STACK_TOP - p) * 4;
+}
+
+size_t diag_stack_size(void) {
+    return (size_t)(DIAG_STACK_TOP - DIAG_STACK_LIMIT) * 4;
+}
+
+void diag_irq_latency(diag_irq_t irq, uint32_t late) {
+    diag_irq_stats_t *s = &irq_stats[irq];
+
+    s->count++;
+    if(late != DIAG_NO_LATENCY && (s->max_latency == DIAG_NO_LATENCY || late > s->max_latency)) {
+        s->max_latency = late;
+    }
+}
+
+void diag_irq_run(diag_irq_t irq, uint32_t cycles) {
+    if(cycles > irq_stats[irq].max_run) {
+        irq_stats[irq].max_run = cycles;
+    }
+}
+
+const diag_irq_stats_t *diag_irq_stats(diag_irq_t irq) {
+    return (irq < DIAG_IRQ_COUNT) ? &irq_stats[irq] : 0;
+}
+
+void diag_dump(uart_num_t uart) {
+    uart_printf(uart, "stack: %u of %u bytes used\r\n",
+                (unsigned)diag_stack_used(), (unsigned)diag_stack_size());
+#if DIAG_ENABLE
+    uint32_t per_us = cycles_per_us();
+
+    uart_printf(uart, "%-8s %8s %8s %6s %8s %6s\r\n",
+                "irq", "count", "lat", "lat_us", "run", "run_us");
+
+    for(uint8_t i = 0; i < DIAG_IRQ_COUNT; i++) {
+        const diag_irq_stats_t *s = &irq_stats[i];
+
+        if(s->count == 0) {
+            continue;
+        }
+        if(s->max_latency == DIAG_NO_LATENCY) {
+            uart_printf(uart, "%-8s %8u %8s %6s %8u %6u\r\n", irq_names[i],
+                        s->count, "-", "-", s->max_run, s->max_run / per_us);
+        } else {
+            uart_printf(uart, "%-8s %8u %8u %6u %8u %6u\r\n", irq_names[i],
+                        s->count, s->max_latency, s->max_latency / per_us,
+                        s->max_run, s->max_run / per_us);
+        }
+    }
+#endif
+}
@@ -0,0 +1,140 @@
+/**
+ * @file diag.h
+ * @brief Stack high-water mark and per-interrupt latency monitor
+ * @note The stack is painted once at boot and scanned on demand. Each
+ *       instrumented handler timestamps its entry with CYCCNT: latency is
+ *       the time since its trigger (the match or reload its peripheral
+ *       counter has just passed), run time is entry to exit. Sections
+ *       with interrupts disabled show up as latency.
+ */
+
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "systick.h"
+#include "uart.h"
+
+/* ==================== Configuration ==================== */
+// Set to 1 (e.g., -DDIAG_ENABLE=1) to build the handler probes in. The
+// stack high-water mark works either way.
+#ifndef DIAG_ENABLE
+#define DIAG_ENABLE         0
+#endif
+
+// Stack bounds, CMSIS GCC linker script symbols by default
+#ifndef DIAG_STACK_LIMIT
+#define DIAG_STACK_LIMIT    __StackLimit    // Lowest stack address
+#endif
+#ifndef DIAG_STACK_TOP
+#define DIAG_STACK_TOP      __StackTop      // Initial MSP
+#endif
+
+#define DIAG_STACK_PAINT    0xA5A5A5A5UL
+#define DIAG_NO_LATENCY     0xFFFFFFFFUL    // Event-driven, no known trigger
+
+/* ==================== Monitored Interrupts ==================== */
+typedef enum {
+    DIAG_IRQ_SYSTICK,       // Latency since the counter reload
+    DIAG_IRQ_PWM1,          // Latency since the earliest pending match
+    DIAG_IRQ_TIMER0,        // Latency since the earliest pending match
+    DIAG_IRQ_TIMER1,
+    DIAG_IRQ_TIMER2,
+    DIAG_IRQ_TIMER3,
+    DIAG_IRQ_UART0,         // Run time only from here on
+    DIAG_IRQ_UART1,
+    DIAG_IRQ_UART2,
+    DIAG_IRQ_UART3,
+    DIAG_IRQ_SSP0,
+    DIAG_IRQ_SSP1,
+    DIAG_IRQ_DMA,
+    DIAG_IRQ_EINT3,
+    DIAG_IRQ_RTC,
+    DIAG_IRQ_COUNT
+} diag_irq_t;
+
+typedef struct {
+    uint32_t count;         // Handler entries
+    uint32_t max_latency;   // Cycles from trigger to entry
+    uint32_t max_run;       // Cycles from entry to exit (with preemption)
+} diag_irq_stats_t;
+
+/* ==================== Handler Macros ==================== */
+#if DIAG_ENABLE
+
+/**
+ * @brief Timestamp handler entry (first statement, once per scope)
+ * @param irq diag_irq_t of the handler
+ * @param late Cycles since the trigger, read from the peripheral counter,
+ *        or DIAG_NO_LATENCY
+ * @example DIAG_IRQ_ENTER(DIAG_IRQ_SYSTICK, SYSTICK->LOAD - SYSTICK->VAL);
+ */
+#define DIAG_IRQ_ENTER(irq, late) \
+    uint32_t diag_entry = cycles(); \
+    diag_irq_latency((irq), (late))
+
+/**
+ * @brief Record the handler run time (last statement)
+ * @param irq Same as DIAG_IRQ_ENTER
+ */
+#define DIAG_IRQ_EXIT(irq) \
+    diag_irq_run((irq), cycles() - diag_entry)
+
+#else
+
+#define DIAG_IRQ_ENTER(irq, late)  do { } while(0)
+#define DIAG_IRQ_EXIT(irq)         do { } while(0)
+
+#endif
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Paint the unused stack below the current stack pointer
+ * @note Call first thing in main(), before the interrupts are enabled
+ */
+void diag_init(void);
+
+/**
+ * @brief Deepest stack use since boot
+ * @return Bytes between the top of the stack and the lowest overwritten word
+ * @note Scans up from DIAG_STACK_LIMIT, main loop only
+ */
+size_t diag_stack_used(void);
+
+/**
+ * @brief Stack size
+ * @return Bytes between DIAG_STACK_LIMIT and DIAG_STACK_TOP
+ */
+size_t diag_stack_size(void);
+
+/**
+ * @brief Count an entry and its latency (used by DIAG_IRQ_ENTER)
+ * @param irq Monitored interrupt
+ * @param late Cycles since the trigger, DIAG_NO_LATENCY if unknown
+ */
+void diag_irq_latency(diag_irq_t irq, uint32_t late);
+
+/**
+ * @brief Record a handler run time (used by DIAG_IRQ_EXIT)
+ * @param irq Monitored interrupt
+ * @param cycles Cycles from entry to exit
+ */
+void diag_irq_run(diag_irq_t irq, uint32_t cycles);
+
+/**
+ * @brief Get the statistics of one interrupt
+ * @param irq Monitored interrupt
+ * @return Statistics since boot, NULL if irq is out of range
+ */
+const diag_irq_stats_t *diag_irq_stats(diag_irq_t irq);
+
+/**
+ * @brief Print the stack high-water mark and every interrupt that has run
+ * @param uart UART to print on (non-blocking TX ring)
+ * @example diag_dump(UART_0);
+ */
+void diag_dump(uart_num_t uart);
+
+#endif // DIAG_H
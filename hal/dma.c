@@ -0,0 +1,125 @@
+/**
+ * @file dma.c
+ * @brief Minimal GPDMA channel HAL implementation
+ */
+
+#include "dma.h"
+#include "diag.h"
+#include <lpc17xx.h>
+
+/* ==================== Register Bits ==================== */
+#define PCONP_PCGPDMA       (1<<29)
+#define DMAC_CONFIG_E       (1<<0)    // Controller enable
+
+// DMACCxControl
+#define CTRL_SI             (1UL<<26) // Source increment
+#define CTRL_DI             (1UL<<27) // Destination increment
+#define CTRL_I              (1UL<<31) // Terminal count interrupt
+#define CTRL_WIDTH_16       ((1UL<<18) | (1UL<<21))  // Source and destination halfword
+
+// DMACCxConfig
+#define CFG_E               (1<<0)    // Channel enable
+#define CFG_SRC_PERIPH(n)   ((n)<<1)
+#define CFG_DST_PERIPH(n)   ((n)<<6)
+#define CFG_TYPE(t)         ((t)<<11)
+#define CFG_IE              (1<<14)   // Error interrupt mask
+#define CFG_ITC             (1<<15)   // Terminal count interrupt mask
+
+/* ==================== Driver State ==================== */
+static LPC_GPDMACH_TypeDef * const dma_channels[DMA_CHANNELS] = {
+    LPC_GPDMACH0, LPC_GPDMACH1, LPC_GPDMACH2, LPC_GPDMACH3,
+    LPC_GPDMACH4, LPC_GPDMACH5, LPC_GPDMACH6, LPC_GPDMACH7
+};
+
+static volatile dma_callback_t dma_callbacks[DMA_CHANNELS];
+
+/* ==================== Interrupt Handler ==================== */
+
+void DMA_IRQHandler(void) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_DMA, DIAG_NO_LATENCY);
+    uint32_t tc = LPC_GPDMA->DMACIntTCStat;
+    uint32_t err = LPC_GPDMA->DMACIntErrStat;
+    uint32_t pending = tc | err;
+    
+    LPC_GPDMA->DMACIntTCClear = tc;
+    LPC_GPDMA->DMACIntErrClr = err;
+    
+    while (pending) {
+        uint8_t ch = 31 - __CLZ(pending);  // Highest pending channel
+        pending &= ~(1UL << ch);
+        
+        dma_callback_t callback = dma_callbacks[ch];
+        if (callback) {
+            callback(ch, (err >> ch) & 1);
+        }
+    }
+    DIAG_IRQ_EXIT(DIAG_IRQ_DMA);
+}
+
+/* ==================== Public Functions ==================== */
+
+void dma_init(void) {
+    // Powered-down peripheral registers must not be accessed, check PCONP first
+    if ((LPC_SC->PCONP & PCONP_PCGPDMA) && (LPC_GPDMA->DMACConfig & DMAC_CONFIG_E)) {
+        return;  // Already running
+    }
+    
+    LPC_SC->PCONP |= PCONP_PCGPDMA;
+    LPC_GPDMA->DMACIntTCClear = 0xFF;
+    LPC_GPDMA->DMACIntErrClr = 0xFF;
+    LPC_GPDMA->DMACConfig = DMAC_CONFIG_E;  // Little-endian masters
+    NVIC_EnableIRQ(DMA_IRQn);
+}
+
+bool dma_start(uint8_t channel, dma_dir_t dir, dma_req_t req,
+               const volatile void *src, volatile void *dst,
+               uint16_t len, dma_callback_t callback) {
+    return dma_start_ex(channel, dir, req, src, dst, len, 0, callback);
+}
+
+bool dma_start_ex(uint8_t channel, dma_dir_t dir, dma_req_t req,
+                  const volatile void *src, volatile void *dst,
+                  uint16_t len, uint8_t flags, dma_callback_t callback) {
+    if (channel >= DMA_CHANNELS || len == 0 || len > DMA_MAX_TRANSFER || dma_busy(channel)) {
+        return false;
+    }
+    
+    LPC_GPDMACH_TypeDef *ch = dma_channels[channel];
+    uint32_t control = len | CTRL_I;  // Burst 1, byte width
+    uint32_t config = CFG_TYPE(dir) | CFG_IE | CFG_ITC;
+    
+    if (flags & DMA_WIDTH_16) {
+        control |= CTRL_WIDTH_16;
+    }
+    
+    if (dir == DMA_M2P) {
+        control |= (flags & DMA_NO_INC) ? 0 : CTRL_SI;
+        config |= CFG_DST_PERIPH(req);
+    } else if (dir == DMA_P2M) {
+        control |= (flags & DMA_NO_INC) ? 0 : CTRL_DI;
+        config |= CFG_SRC_PERIPH(req);
+    } else {
+        control |= CTRL_SI | CTRL_DI;
+    }
+    
+    dma_callbacks[channel] = callback;
+    LPC_GPDMA->DMACIntTCClear = 1UL << channel;
+    LPC_GPDMA->DMACIntErrClr = 1UL << channel;
+    
+    ch->DMACCSrcAddr = (uint32_t)(uintptr_t)src;
+    ch->DMACCDestAddr = (uint32_t)(uintptr_t)dst;
+    ch->DMACCLLI = 0;
+    ch->DMACCControl = control;
+    ch->DMACCConfig = config | CFG_E;
+    return true;
+}
+
+bool dma_busy(uint8_t channel) {
+    return (LPC_GPDMA->DMACEnbldChns >> channel) & 1;
+}
+
+void dma_abort(uint8_t channel) {
+    dma_channels[channel]->DMACCConfig = 0;
+    LPC_GPDMA->DMACIntTCClear = 1UL << channel;
+    LPC_GPDMA->DMACIntErrClr = 1UL << channel;
+}
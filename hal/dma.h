@@ -0,0 +1,95 @@
+/**
+ * @file dma.h
+ * @brief Minimal GPDMA channel HAL for LPC1768
+ * @note Shares the single DMA interrupt between drivers by channel
+ */
+
+#ifndef DMA_H
+#define DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ==================== Channels ==================== */
+#define DMA_CHANNELS       8
+#define DMA_MAX_TRANSFER   4095  // 12-bit TransferSize field
+
+/* ==================== Transfer Direction ==================== */
+typedef enum {
+    DMA_M2M = 0,  // Memory to memory (both addresses increment)
+    DMA_M2P = 1,  // Memory to peripheral (source increments)
+    DMA_P2M = 2   // Peripheral to memory (destination increments)
+} dma_dir_t;
+
+/* ==================== Peripheral Requests ==================== */
+typedef enum {
+    DMA_REQ_SSP0_TX  = 0,
+    DMA_REQ_SSP0_RX  = 1,
+    DMA_REQ_SSP1_TX  = 2,
+    DMA_REQ_SSP1_RX  = 3,
+    DMA_REQ_UART0_TX = 8,
+    DMA_REQ_UART0_RX = 9,
+    DMA_REQ_UART1_TX = 10,
+    DMA_REQ_UART1_RX = 11,
+    DMA_REQ_UART2_TX = 12,
+    DMA_REQ_UART2_RX = 13,
+    DMA_REQ_UART3_TX = 14,
+    DMA_REQ_UART3_RX = 15,
+    DMA_REQ_NONE     = 0   // Memory side of a transfer
+} dma_req_t;
+
+/* ==================== Transfer Options ==================== */
+#define DMA_WIDTH_16       (1 << 0)  // Halfword units, len counts halfwords
+#define DMA_NO_INC         (1 << 1)  // Memory side stays on one item (fill/discard)
+
+/* ==================== Types ==================== */
+// Called from DMA_IRQHandler when a channel finishes (error = true on bus error)
+typedef void (*dma_callback_t)(uint8_t channel, bool error);
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Power on GPDMA and enable its interrupt
+ * @note Safe to call more than once (every DMA user calls it)
+ */
+void dma_init(void);
+
+/**
+ * @brief Start a byte-wide transfer on a channel
+ * @param channel Channel 0-7 (lower number = higher priority)
+ * @param dir Transfer direction
+ * @param req Peripheral request line (ignored for DMA_M2M)
+ * @param src Source address
+ * @param dst Destination address
+ * @param len Number of bytes (1 - DMA_MAX_TRANSFER)
+ * @param callback Completion callback (may be NULL)
+ * @return false if the channel is busy or len is out of range
+ */
+bool dma_start(uint8_t channel, dma_dir_t dir, dma_req_t req,
+               const volatile void *src, volatile void *dst,
+               uint16_t len, dma_callback_t callback);
+
+/**
+ * @brief Start a transfer with options
+ * @param flags DMA_WIDTH_16 and/or DMA_NO_INC (peripheral transfers only),
+ *        0 for the dma_start() byte transfer
+ * @note Other parameters as dma_start()
+ * @example dma_start_ex(0, DMA_M2P, DMA_REQ_SSP0_TX, words, &LPC_SSP0->DR, 4, DMA_WIDTH_16, done);
+ */
+bool dma_start_ex(uint8_t channel, dma_dir_t dir, dma_req_t req,
+                  const volatile void *src, volatile void *dst,
+                  uint16_t len, uint8_t flags, dma_callback_t callback);
+
+/**
+ * @brief Check if a channel is still transferring
+ * @param channel Channel 0-7
+ */
+bool dma_busy(uint8_t channel);
+
+/**
+ * @brief Stop a channel immediately (no callback)
+ * @param channel Channel 0-7
+ */
+void dma_abort(uint8_t channel);
+
+#endif // DMA_H
@@ -0,0 +1,55 @@
+/**
+ * @file event.c
+ * @brief ISR-to-main event queue implementation
+ */
+
+#include "event.h"
+#include "ringbuf.h"
+
+static event_t event_storage[EVENT_SRC_COUNT][EVENT_QUEUE_SIZE];
+static ringbuf_t event_queues[EVENT_SRC_COUNT];
+static volatile uint32_t dropped_count[EVENT_SRC_COUNT];  // Per-source, so each has one writer
+static volatile event_notify_t notify_hook = 0;
+
+void event_init(void) {
+    for (uint8_t i = 0; i < EVENT_SRC_COUNT; i++) {
+        ringbuf_init(&event_queues[i], event_storage[i], sizeof(event_t), EVENT_QUEUE_SIZE);
+        dropped_count[i] = 0;
+    }
+}
+
+bool event_post(event_source_t source, uint8_t type, uint8_t id, uint16_t value) {
+    event_t event = { type, id, value };
+
+    if (!ringbuf_put(&event_queues[source], &event)) {
+        dropped_count[source]++;
+        return false;
+    }
+    
+    event_notify_t notify = notify_hook;
+    if (notify) {
+        notify();
+    }
+    return true;
+}
+
+bool event_get(event_t *event) {
+    for (uint8_t i = 0; i < EVENT_SRC_COUNT; i++) {
+        if (ringbuf_get(&event_queues[i], event)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void event_set_notify(event_notify_t notify) {
+    notify_hook = notify;
+}
+
+uint32_t event_dropped(void) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < EVENT_SRC_COUNT; i++) {
+        total += dropped_count[i];
+    }
+    return total;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file event.h
+ * @brief ISR-to-main event queue for LPC1768
+ * @note Built on ringbuf.h: one lock-free queue per producer context, so
+ *       several ISRs can post without disabling interrupts
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ==================== Configuration ==================== */
+// Events per source queue (power of 2)
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE  16
+#endif
+
+/* ==================== Event Sources ==================== */
+// Each source must only be posted from ONE context (single producer)
+typedef enum {
+    EVENT_SRC_SYSTICK = 0,  // SysTick_Handler and its callbacks
+    EVENT_SRC_TIMER   = 1,  // TIMERn_IRQHandler
+    EVENT_SRC_UART    = 2,  // UARTn_IRQHandler
+    EVENT_SRC_MAIN    = 3,  // Main loop (deferred work)
+    EVENT_SRC_COUNT
+} event_source_t;
+
+/* ==================== Event Types ==================== */
+typedef enum {
+    EVENT_NONE    = 0,
+    EVENT_BUTTON  = 1,  // id = button, value = input_event_type_t
+    EVENT_TICK    = 2,  // id = tick source, value = tick count
+    EVENT_UART_RX = 3,  // id = uart_num_t, value = bytes available
+    EVENT_UART_TX = 4   // id = uart_num_t, value = 0 (TX drained)
+} event_type_t;
+
+typedef struct {
+    uint8_t type;    // event_type_t
+    uint8_t id;      // Type-specific identifier
+    uint16_t value;  // Type-specific payload
+} event_t;
+
+// Called in the posting context after every queued event
+typedef void (*event_notify_t)(void);
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Initialize (empty) all event queues
+ */
+void event_init(void);
+
+/**
+ * @brief Post an event
+ * @param source Queue of the calling context (see event_source_t)
+ * @param type Event type
+ * @param id Type-specific identifier
+ * @param value Type-specific payload
+ * @return true if queued, false if that source's queue is full
+ * @example event_post(EVENT_SRC_SYSTICK, EVENT_BUTTON, BUTTON_START, INPUT_PRESS);
+ */
+bool event_post(event_source_t source, uint8_t type, uint8_t id, uint16_t value);
+
+/**
+ * @brief Fetch the next event (main loop only, non-blocking)
+ * @param event Filled with the oldest event of the lowest-numbered non-empty source
+ * @return true if an event was returned, false if all queues are empty
+ */
+bool event_get(event_t *event);
+
+/**
+ * @brief Set a function to call whenever an event is queued
+ * @param notify Hook (ISR-safe, keep it short), NULL to remove
+ * @example event_set_notify(wake_input_task);  // Release the consumer task
+ */
+void event_set_notify(event_notify_t notify);
+
+/**
+ * @brief Number of events dropped because a queue was full
+ */
+uint32_t event_dropped(void);
+
+#endif // EVENT_H
@@ -0,0 +1,132 @@
+/**
+ * @file frame.c
+ * @brief Binary message framing implementation
+ */
+
+#include "frame.h"
+#include <lpc17xx.h>
+
+static uint32_t dropped_count = 0;
+
+// Text frame in progress (frame_text_attach())
+static uint8_t text_id;
+static uint8_t text_buf[FRAME_MAX_PAYLOAD];
+static uint8_t text_len = 0;
+
+// CRC-16/CCITT one nibble at a time: 16-entry table, no per-bit loop
+static const uint16_t crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t frame_crc16(uint16_t crc, const uint8_t *data, size_t len) {
+    while(len--) {
+        crc ^= (uint16_t)*data++ << 8;
+        crc = (crc << 4) ^ crc_nibble[crc >> 12];
+        crc = (crc << 4) ^ crc_nibble[crc >> 12];
+    }
+    return crc;
+}
+
+size_t frame_encode(uint8_t id, const void *payload, size_t len, uint8_t *out) {
+    uint8_t raw[FRAME_RAW_MAX];
+    const uint8_t *src = (const uint8_t *)payload;
+
+    if(len > FRAME_MAX_PAYLOAD) {
+        return 0;
+    }
+
+    // 1. id, payload, crc16 (little-endian)
+    raw[0] = id;
+    for(size_t i = 0; i < len; i++) {
+        raw[1 + i] = src[i];
+    }
+    uint16_t crc = frame_crc16(FRAME_CRC_INIT, raw, len + 1);
+    raw[len + 1] = crc & 0xFF;
+    raw[len + 2] = crc >> 8;
+
+    // 2. Leading delimiter, then COBS: each code byte gives the distance
+    //    to the next zero
+    size_t n = len + 3;
+    out[0] = FRAME_DELIMITER;
+    size_t code_pos = 1;
+    size_t o = 2;
+    uint8_t code = 1;
+
+    for(size_t i = 0; i < n; i++) {
+        if(raw[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        } else {
+            out[o++] = raw[i];
+            if(++code == 0xFF) {  // Block full, start a new one
+                out[code_pos] = code;
+                code_pos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+
+    // 3. Trailing delimiter
+    out[o++] = FRAME_DELIMITER;
+    return o;
+}
+
+bool frame_send(uart_num_t uart, uint8_t id, const void *payload, size_t len) {
+    uint8_t buf[FRAME_ENCODED_MAX];
+    size_t n = frame_encode(id, payload, len, buf);
+
+    // Never queue a partial frame, the receiver would lose two
+    if(n == 0 || uart_tx_space(uart) < n) {
+        dropped_count++;
+        return false;
+    }
+    uart_write(uart, buf, n);
+    return true;
+}
+
+// Text must not be lost: wait for room, as uart_puts() does. With IRQs
+// masked the ISR cannot drain the buffer, so a frame that does not fit
+// is dropped instead.
+static void text_flush(uart_num_t uart) {
+    uint8_t buf[FRAME_ENCODED_MAX];
+    size_t n = frame_encode(text_id, text_buf, text_len, buf);
+    text_len = 0;
+
+    while(uart_tx_space(uart) < n) {
+        if(__get_PRIMASK()) {
+            dropped_count++;
+            return;
+        }
+    }
+    uart_write(uart, buf, n);
+}
+
+// Flushed at each '\n', a full frame and the end of every uart_putc(),
+// uart_puts() and uart_printf() call (len = 0), so echoed keys go out
+static void text_hook(uart_num_t uart, const char *text, size_t len) {
+    if(len == 0) {
+        if(text_len > 0) {
+            text_flush(uart);
+        }
+        return;
+    }
+    for(size_t i = 0; i < len; i++) {
+        text_buf[text_len++] = (uint8_t)text[i];
+        if(text[i] == '\n' || text_len == FRAME_MAX_PAYLOAD) {
+            text_flush(uart);
+        }
+    }
+}
+
+void frame_text_attach(uart_num_t uart, uint8_t id) {
+    text_id = id;
+    text_len = 0;
+    uart_set_text_hook(uart, text_hook);
+}
+
+uint32_t frame_dropped(void) {
+    return dropped_count;
+}
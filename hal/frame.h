@@ -0,0 +1,83 @@
+/**
+ * @file frame.h
+ * @brief Binary message framing over UART (COBS + CRC-16)
+ * @note Frame on the wire: 0x00, COBS(id, payload, crc16), 0x00. The
+ *       leading delimiter ends any garbage before it (line noise, a frame
+ *       cut short), so the receiver never merges it into the frame.
+ *       CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over id and payload,
+ *       sent little-endian.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "uart.h"
+
+/* ==================== Configuration ==================== */
+// Largest payload per frame
+#ifndef FRAME_MAX_PAYLOAD
+#define FRAME_MAX_PAYLOAD   32
+#endif
+
+#define FRAME_DELIMITER     0x00
+#define FRAME_CRC_INIT      0xFFFF
+
+// id + payload + crc, plus one COBS code byte per 254 bytes, plus delimiters
+#define FRAME_RAW_MAX       (1 + FRAME_MAX_PAYLOAD + 2)
+#define FRAME_ENCODED_MAX   (FRAME_RAW_MAX + FRAME_RAW_MAX / 254 + 1 + 2)
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE
+ * @param crc Running value (FRAME_CRC_INIT to start)
+ * @param data Bytes to add
+ * @param len Number of bytes
+ * @return New CRC
+ */
+uint16_t frame_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Build a complete frame
+ * @param id Message ID
+ * @param payload Payload bytes (may be NULL if len is 0)
+ * @param len Payload length, at most FRAME_MAX_PAYLOAD
+ * @param out Buffer of FRAME_ENCODED_MAX bytes
+ * @return Frame length including both delimiters, 0 if len is too large
+ */
+size_t frame_encode(uint8_t id, const void *payload, size_t len, uint8_t *out);
+
+/**
+ * @brief Queue a frame on a UART (non-blocking, all or nothing)
+ * @param uart UART number
+ * @param id Message ID
+ * @param payload Payload bytes
+ * @param len Payload length
+ * @return false if the TX buffer has no room for the whole frame (dropped)
+ * @example frame_send(UART_2, MSG_STATE, &state, 1);  // 7 bytes on the wire
+ */
+bool frame_send(uart_num_t uart, uint8_t id, const void *payload, size_t len);
+
+/**
+ * @brief Carry the text output of a UART (uart_puts(), uart_printf()) in frames
+ * @param uart UART shared with frame_send()
+ * @param id Message ID of the text frames, payload = the characters
+ * @note Text is cut into frames after each '\n', every FRAME_MAX_PAYLOAD
+ *       characters and at the end of each uart_putc(), uart_puts() or
+ *       uart_printf() call, so console echo is not held back. Waits for TX
+ *       space like uart_puts() instead of dropping, unless IRQs are masked.
+ *       One UART at a time.
+ * @example frame_text_attach(UART_2, TLM_MSG_TEXT);  // Console and telemetry
+ */
+void frame_text_attach(uart_num_t uart, uint8_t id);
+
+/**
+ * @brief Number of frames dropped for lack of TX space: by frame_send(),
+ *        and text frames flushed with IRQs masked
+ */
+uint32_t frame_dropped(void);
+
+#endif // FRAME_H
@@ -3,7 +3,9 @@
  * @brief Simple GPIO HAL Implementation for LPC1768
  */
 
+#define GPIO_NO_FAST_PATH  // This file defines the out-of-line functions
 #include "gpio.h"
+#include "diag.h"
 #include <lpc17xx.h>
 
 /* ==================== LPC1768 Register Definitions ==================== */
@@ -48,12 +50,17 @@ typedef struct {
 
 // Already defined in lpc17xx.h
 
+/* ==================== Interrupt State ==================== */
+// Per-pin callbacks for the two interrupt-capable ports (P0, P2)
+static volatile gpio_irq_callback_t irq_callbacks[2][32];
+
+#define GPIOINT_P0INT   (1 << 0)  // IntStatus: port 0 interrupt pending
+#define GPIOINT_P2INT   (1 << 2)  // IntStatus: port 2 interrupt pending
+
 /* ==================== Helper Functions ==================== */
 
-// Get GPIO port structure from pin number
-static LPC_GPIO_TypeDef* get_gpio_port(uint8_t pin) {
-    uint8_t port = pin >> 5;  // Extract port number (bits 7:5)
-    
+// Get GPIO port structure from port number
+static LPC_GPIO_TypeDef* get_gpio_port_num(uint8_t port) {
     switch(port) {
         case 0: return LPC_GPIO0;
         case 1: return LPC_GPIO1;
@@ -64,6 +71,11 @@ static LPC_GPIO_TypeDef* get_gpio_port(uint8_t pin) {
     }
 }
 
+// Get GPIO port structure from pin number
+static LPC_GPIO_TypeDef* get_gpio_port(uint8_t pin) {
+    return get_gpio_port_num(pin >> 5);  // Extract port number (bits 7:5)
+}
+
 // Get pin mask from pin number
 static uint32_t get_pin_mask(uint8_t pin) {
     uint8_t pin_num = pin & 0x1F;  // Extract pin number (bits 4:0)
@@ -93,8 +105,8 @@ static void set_pin_function(uint8_t pin) {
         return;
     }
     
-    // Clear and set function bits (00 = GPIO)
-    *pinsel_reg &= ~(0x3 << bit_pos);
+    // Clear function bits (00 = GPIO) in one write, as gpio_config_table()
+    *pinsel_reg &= ~(0x3UL << bit_pos);
 }
 
 // Configure pin pull mode
@@ -120,9 +132,53 @@ static void set_pin_pull(uint8_t pin, gpio_pull_t pull) {
         return;
     }
     
-    // Clear and set pull mode bits
-    *pinmode_reg &= ~(0x3 << bit_pos);
-    *pinmode_reg |= (pull << bit_pos);
+    // Write both pull mode bits in one write, no intermediate mode on the pin
+    *pinmode_reg = (*pinmode_reg & ~(0x3UL << bit_pos)) | ((uint32_t)(pull & 0x3) << bit_pos);
+}
+
+// Run callbacks for every pin with a pending edge on one port
+static void dispatch_port_irq(uint8_t idx, uint32_t rise, uint32_t fall) {
+    uint32_t pending = rise | fall;
+    uint8_t port = idx * 2;  // Index 0 = P0, 1 = P2
+    
+    // CLZ finds each set bit directly instead of testing all 32 pins
+    while (pending) {
+        uint8_t bit = 31 - __CLZ(pending);
+        uint32_t mask = 1UL << bit;
+        pending &= ~mask;
+        
+        gpio_irq_callback_t callback = irq_callbacks[idx][bit];
+        if (callback) {
+            gpio_edge_t edge = (gpio_edge_t)(((rise & mask) ? GPIO_EDGE_RISING : 0) |
+                                             ((fall & mask) ? GPIO_EDGE_FALLING : 0));
+            callback(GPIO_PIN(port, bit), edge);
+        }
+    }
+}
+
+/* ==================== Interrupt Handler ==================== */
+
+/**
+ * @brief EINT3 interrupt handler (shared by all GPIO interrupts)
+ */
+void EINT3_IRQHandler(void) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_EINT3, DIAG_NO_LATENCY);
+    uint32_t status = LPC_GPIOINT->IntStatus;
+    
+    if (status & GPIOINT_P0INT) {
+        uint32_t rise = LPC_GPIOINT->IO0IntStatR;
+        uint32_t fall = LPC_GPIOINT->IO0IntStatF;
+        LPC_GPIOINT->IO0IntClr = rise | fall;
+        dispatch_port_irq(0, rise, fall);
+    }
+    
+    if (status & GPIOINT_P2INT) {
+        uint32_t rise = LPC_GPIOINT->IO2IntStatR;
+        uint32_t fall = LPC_GPIOINT->IO2IntStatF;
+        LPC_GPIOINT->IO2IntClr = rise | fall;
+        dispatch_port_irq(1, rise, fall);
+    }
+    DIAG_IRQ_EXIT(DIAG_IRQ_EINT3);
 }
 
 /* ==================== Public Functions ==================== */
@@ -133,20 +189,70 @@ void gpio_init(void) {
 }
 
 void gpio_config(uint8_t pin, gpio_dir_t dir, gpio_pull_t pull) {
-    LPC_GPIO_TypeDef *gpio = get_gpio_port(pin);
-    uint32_t mask = get_pin_mask(pin);
-    
     // 1. Set pin function to GPIO (00)
     set_pin_function(pin);
     
     // 2. Configure pull mode
     set_pin_pull(pin, pull);
     
-    // 3. Set direction
-    if (dir == GPIO_OUTPUT) {
-        gpio->FIODIR |= mask;   // Set bit = output
-    } else {
-        gpio->FIODIR &= ~mask;  // Clear bit = input
+    // 3. Set direction (1 = output, 0 = input)
+    gpio_bb_dir(pin, dir);
+}
+
+void gpio_config_table(const gpio_pin_cfg_t *cfg, size_t n) {
+    // PINSELn/PINMODEn index = port * 2 + (pin >= 16), registers are contiguous
+    uint32_t sel_clr[10] = {0}, sel_set[10] = {0};
+    uint32_t mode_clr[10] = {0}, mode_set[10] = {0};
+    uint32_t dir_out[5] = {0}, dir_in[5] = {0};
+    uint32_t lvl_high[5] = {0}, lvl_low[5] = {0};
+    
+    // 1. Merge all entries into per-register masks
+    for (size_t i = 0; i < n; i++) {
+        uint8_t port = cfg[i].pin >> 5;
+        uint8_t pin_num = cfg[i].pin & 0x1F;
+        uint8_t reg = port * 2 + (pin_num >> 4);
+        uint8_t bit_pos = (pin_num % 16) * 2;
+        uint32_t mask = get_pin_mask(cfg[i].pin);
+        
+        if (port > 4) {
+            continue;
+        }
+        
+        sel_clr[reg] |= 0x3UL << bit_pos;
+        sel_set[reg] |= (uint32_t)(cfg[i].func & 0x3) << bit_pos;
+        mode_clr[reg] |= 0x3UL << bit_pos;
+        mode_set[reg] |= (uint32_t)(cfg[i].pull & 0x3) << bit_pos;
+        
+        if (cfg[i].func == 0) {
+            if (cfg[i].dir == GPIO_OUTPUT) {
+                dir_out[port] |= mask;
+                if (cfg[i].level == GPIO_HIGH) {
+                    lvl_high[port] |= mask;
+                } else {
+                    lvl_low[port] |= mask;
+                }
+            } else {
+                dir_in[port] |= mask;
+            }
+        }
+    }
+    
+    // 2. One write per touched register
+    for (uint8_t reg = 0; reg < 10; reg++) {
+        if (sel_clr[reg]) {
+            (&PINSEL0)[reg] = ((&PINSEL0)[reg] & ~sel_clr[reg]) | sel_set[reg];
+            (&PINMODE0)[reg] = ((&PINMODE0)[reg] & ~mode_clr[reg]) | mode_set[reg];
+        }
+    }
+    
+    for (uint8_t port = 0; port < 5; port++) {
+        LPC_GPIO_TypeDef *gpio = get_gpio_port_num(port);
+        
+        if (lvl_high[port]) gpio->FIOSET = lvl_high[port];
+        if (lvl_low[port]) gpio->FIOCLR = lvl_low[port];
+        if (dir_out[port] | dir_in[port]) {
+            gpio->FIODIR = (gpio->FIODIR & ~dir_in[port]) | dir_out[port];
+        }
     }
 }
 
@@ -173,6 +279,61 @@ void gpio_toggle(uint8_t pin) {
     LPC_GPIO_TypeDef *gpio = get_gpio_port(pin);
     uint32_t mask = get_pin_mask(pin);
     
-    // XOR to toggle
-    gpio->FIOPIN ^= mask;
-}
\ No newline at end of file
+    // Set or clear just this pin (no read-modify-write of the whole port)
+    if (gpio->FIOPIN & mask) {
+        gpio->FIOCLR = mask;
+    } else {
+        gpio->FIOSET = mask;
+    }
+}
+
+int gpio_attach_irq(uint8_t pin, gpio_edge_t edge, gpio_irq_callback_t callback) {
+    uint8_t port = pin >> 5;
+    uint8_t pin_num = pin & 0x1F;
+    
+    if (port != 0 && port != 2) {
+        return -1;  // Only P0 and P2 have GPIO interrupts
+    }
+    
+    uint8_t idx = port >> 1;
+    volatile uint32_t *en_r = idx ? &LPC_GPIOINT->IO2IntEnR : &LPC_GPIOINT->IO0IntEnR;
+    volatile uint32_t *en_f = idx ? &LPC_GPIOINT->IO2IntEnF : &LPC_GPIOINT->IO0IntEnF;
+    volatile uint32_t *clr = idx ? &LPC_GPIOINT->IO2IntClr : &LPC_GPIOINT->IO0IntClr;
+    
+    irq_callbacks[idx][pin_num] = callback;
+    *clr = get_pin_mask(pin);  // Drop any stale edge
+    
+    // Bit-band: enabling one pin cannot clobber another pin's enable
+    GPIO_BITBAND(en_r, pin_num) = (edge & GPIO_EDGE_RISING) ? 1 : 0;
+    GPIO_BITBAND(en_f, pin_num) = (edge & GPIO_EDGE_FALLING) ? 1 : 0;
+    
+    NVIC_EnableIRQ(EINT3_IRQn);
+    return 0;
+}
+
+void gpio_detach_irq(uint8_t pin) {
+    uint8_t port = pin >> 5;
+    uint8_t pin_num = pin & 0x1F;
+    
+    if (port != 0 && port != 2) {
+        return;
+    }
+    
+    uint8_t idx = port >> 1;
+    GPIO_BITBAND(idx ? &LPC_GPIOINT->IO2IntEnR : &LPC_GPIOINT->IO0IntEnR, pin_num) = 0;
+    GPIO_BITBAND(idx ? &LPC_GPIOINT->IO2IntEnF : &LPC_GPIOINT->IO0IntEnF, pin_num) = 0;
+    irq_callbacks[idx][pin_num] = 0;
+}
+
+void gpio_port_write_masked(uint8_t port, uint32_t mask, uint32_t value) {
+    LPC_GPIO_TypeDef *gpio = get_gpio_port_num(port);
+    
+    // FIOMASK: 1 = pin ignored by FIOPIN writes, so invert the caller's mask
+    gpio->FIOMASK = ~mask;
+    gpio->FIOPIN = value;
+    gpio->FIOMASK = 0;  // Restore default so single-pin writes see all bits
+}
+
+uint32_t gpio_port_read(uint8_t port) {
+    return get_gpio_port_num(port)->FIOPIN;
+}
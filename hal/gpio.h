@@ -7,6 +7,7 @@
 #define GPIO_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /* ==================== Pin Naming ==================== */
 // Use PORT and PIN like Arduino: GPIO_PIN(0, 22) = P0.22
@@ -14,12 +15,33 @@
 
 // Quick pin definitions (add more as needed)
 #define P0_0    GPIO_PIN(0, 0)
+#define P0_1    GPIO_PIN(0, 1)
+#define P0_2    GPIO_PIN(0, 2)
+#define P0_3    GPIO_PIN(0, 3)
+#define P0_4    GPIO_PIN(0, 4)
+#define P0_5    GPIO_PIN(0, 5)
+#define P0_6    GPIO_PIN(0, 6)
+#define P0_7    GPIO_PIN(0, 7)
+#define P0_8    GPIO_PIN(0, 8)
+#define P0_9    GPIO_PIN(0, 9)
+#define P0_15   GPIO_PIN(0, 15)
+#define P0_16   GPIO_PIN(0, 16)
+#define P0_17   GPIO_PIN(0, 17)
+#define P0_18   GPIO_PIN(0, 18)
 #define P0_22   GPIO_PIN(0, 22)   
 #define P1_18   GPIO_PIN(1, 18)   
 #define P1_20   GPIO_PIN(1, 20)   
 #define P1_21   GPIO_PIN(1, 21)   
+#define P1_22   GPIO_PIN(1, 22)
 #define P1_23   GPIO_PIN(1, 23)
 #define P2_0    GPIO_PIN(2, 0)
+#define P2_1    GPIO_PIN(2, 1)
+#define P2_2    GPIO_PIN(2, 2)
+#define P2_3    GPIO_PIN(2, 3)
+
+// Split a pin number back into its port and bit mask
+#define GPIO_PORT_OF(pin)    ((pin) >> 5)
+#define GPIO_MASK_OF(pin)    (1UL << ((pin) & 0x1F))
 
 /* ==================== Direction ==================== */
 typedef enum {
@@ -41,6 +63,31 @@ typedef enum {
     GPIO_HIGH = 1
 } gpio_state_t;
 
+/* ==================== Interrupt Edge ==================== */
+typedef enum {
+    GPIO_EDGE_RISING  = 1,
+    GPIO_EDGE_FALLING = 2,
+    GPIO_EDGE_BOTH    = 3
+} gpio_edge_t;
+
+// Called from EINT3_IRQHandler with the pin and the edge that fired
+typedef void (*gpio_irq_callback_t)(uint8_t pin, gpio_edge_t edge);
+
+/* ==================== Pin Table Entry ==================== */
+// One entry of a gpio_config_table() pin map (declare the table const so it
+// stays in flash)
+typedef struct {
+    uint8_t pin;    // Pin number (GPIO_PIN / Px_y)
+    uint8_t func;   // PINSEL function: 0 = GPIO, 1-3 = alternate functions
+    uint8_t dir;    // gpio_dir_t (GPIO pins only)
+    uint8_t pull;   // gpio_pull_t
+    uint8_t level;  // gpio_state_t driven before the pin becomes an output
+} gpio_pin_cfg_t;
+
+// Shorthands for GPIO entries
+#define GPIO_CFG_OUT(pin, level)  { (pin), 0, GPIO_OUTPUT, GPIO_PULL_NONE, (level) }
+#define GPIO_CFG_IN(pin, pull)    { (pin), 0, GPIO_INPUT, (pull), GPIO_LOW }
+
 /* ==================== Functions ==================== */
 
 /**
@@ -53,10 +100,25 @@ void gpio_init(void);
  * @param pin Pin number (use GPIO_PIN macro or Px_y defines)
  * @param dir Direction: GPIO_INPUT or GPIO_OUTPUT
  * @param pull Pull mode: GPIO_PULL_NONE, GPIO_PULL_UP, GPIO_PULL_DOWN
+ * @note PINSEL and PINMODE take one masked read-modify-write each, like
+ *       gpio_config_table(), so the two bits of a field change together.
+ *       FIODIR is set through its bit-band alias.
  * @example gpio_config(P0_22, GPIO_OUTPUT, GPIO_PULL_NONE);
  */
 void gpio_config(uint8_t pin, gpio_dir_t dir, gpio_pull_t pull);
 
+/**
+ * @brief Configure many pins in one pass
+ * @param cfg Pin map (typically a const table in flash)
+ * @param n Number of entries
+ * @note Entries are merged so every PINSEL, PINMODE and FIODIR register is
+ *       written once. Output levels are set before the direction changes,
+ *       so outputs never glitch at startup.
+ * @example static const gpio_pin_cfg_t pins[] = { GPIO_CFG_OUT(P0_22, GPIO_LOW) };
+ *          gpio_config_table(pins, sizeof(pins) / sizeof(pins[0]));
+ */
+void gpio_config_table(const gpio_pin_cfg_t *cfg, size_t n);
+
 /**
  * @brief Write value to GPIO pin (must be configured as OUTPUT)
  * @param pin Pin number
@@ -74,9 +136,174 @@ gpio_state_t gpio_read(uint8_t pin);
 /**
  * @brief Toggle GPIO pin output
  * @param pin Pin number (must be configured as OUTPUT)
+ * @note Only this pin is written, so concurrent writes to other pins of the
+ *       port are never lost
  */
 void gpio_toggle(uint8_t pin);
 
+/**
+ * @brief Call a function when a pin changes
+ * @param pin Pin number, port 0 or 2 only (the only LPC1768 ports with
+ *            GPIO interrupts)
+ * @param edge GPIO_EDGE_RISING, GPIO_EDGE_FALLING or GPIO_EDGE_BOTH
+ * @param callback Runs in EINT3 interrupt context
+ * @return 0 on success, -1 if the pin cannot generate interrupts
+ * @example gpio_attach_irq(P0_22, GPIO_EDGE_FALLING, on_button);
+ */
+int gpio_attach_irq(uint8_t pin, gpio_edge_t edge, gpio_irq_callback_t callback);
+
+/**
+ * @brief Stop interrupts from a pin
+ * @param pin Pin number (port 0 or 2)
+ */
+void gpio_detach_irq(uint8_t pin);
+
+/**
+ * @brief Write several pins of one port in a single store
+ * @param port Port number (0-4)
+ * @param mask Bits to update (1 = pin is written, 0 = pin left untouched)
+ * @param value New pin levels, only bits set in mask are used
+ * @note Uses FIOMASK/FIOPIN, so an ISR writing FIOPIN on the same port
+ *       must not preempt this call
+ * @example gpio_port_write_masked(0, 0xFF, 0x3F);  // P0.0-P0.7 = 0x3F
+ */
+void gpio_port_write_masked(uint8_t port, uint32_t mask, uint32_t value);
+
+/**
+ * @brief Read all pins of one port
+ * @param port Port number (0-4)
+ * @return FIOPIN value of the port
+ */
+uint32_t gpio_port_read(uint8_t port);
+
+/* ==================== Inline Fast Path ==================== */
+// Fast GPIO register addresses, computed at compile time for constant pins.
+// GPIO_FIO_REG and GPIO_BITBAND may be predefined to route these accesses to
+// another register backend (e.g., a host-side mock).
+#define GPIO_FIO_BASE           0x2009C000UL
+#define GPIO_FIO_STRIDE         0x20UL
+#ifndef GPIO_FIO_REG
+#define GPIO_FIO_REG(port, off) (*(volatile uint32_t *)(GPIO_FIO_BASE + (port) * GPIO_FIO_STRIDE + (off)))
+#endif
+#define GPIO_FIODIR(port)       GPIO_FIO_REG(port, 0x00)
+#define GPIO_FIOMASK(port)      GPIO_FIO_REG(port, 0x10)
+#define GPIO_FIOPIN(port)       GPIO_FIO_REG(port, 0x14)
+#define GPIO_FIOSET(port)       GPIO_FIO_REG(port, 0x18)
+#define GPIO_FIOCLR(port)       GPIO_FIO_REG(port, 0x1C)
+
+/**
+ * @brief Inline gpio_write(): a single FIOSET/FIOCLR store for a constant pin
+ */
+static inline void gpio_write_fast(uint8_t pin, gpio_state_t value) {
+    if (value == GPIO_HIGH) {
+        GPIO_FIOSET(GPIO_PORT_OF(pin)) = GPIO_MASK_OF(pin);
+    } else {
+        GPIO_FIOCLR(GPIO_PORT_OF(pin)) = GPIO_MASK_OF(pin);
+    }
+}
+
+/**
+ * @brief Inline gpio_read(): a single FIOPIN load for a constant pin
+ */
+static inline gpio_state_t gpio_read_fast(uint8_t pin) {
+    return (GPIO_FIOPIN(GPIO_PORT_OF(pin)) & GPIO_MASK_OF(pin)) ? GPIO_HIGH : GPIO_LOW;
+}
+
+/**
+ * @brief Inline gpio_toggle() for a constant pin
+ */
+static inline void gpio_toggle_fast(uint8_t pin) {
+    // Set or clear just this pin, other pins are not read back and rewritten
+    if (GPIO_FIOPIN(GPIO_PORT_OF(pin)) & GPIO_MASK_OF(pin)) {
+        GPIO_FIOCLR(GPIO_PORT_OF(pin)) = GPIO_MASK_OF(pin);
+    } else {
+        GPIO_FIOSET(GPIO_PORT_OF(pin)) = GPIO_MASK_OF(pin);
+    }
+}
+
+/**
+ * @brief Inline gpio_port_write_masked() for a constant port
+ */
+static inline void gpio_port_write_masked_fast(uint8_t port, uint32_t mask, uint32_t value) {
+    GPIO_FIOMASK(port) = ~mask;
+    GPIO_FIOPIN(port) = value;
+    GPIO_FIOMASK(port) = 0;
+}
+
+/**
+ * @brief Inline gpio_port_read() for a constant port
+ */
+static inline uint32_t gpio_port_read_fast(uint8_t port) {
+    return GPIO_FIOPIN(port);
+}
+
+/* ==================== Bit-Band Access ==================== */
+// Cortex-M3 bit-band alias of one bit of a register in the SRAM (GPIO at
+// 0x2009C000) or peripheral (PINCON at 0x4002C000) region. Each alias
+// word reads/writes exactly one bit in a single bus transaction.
+#ifndef GPIO_BITBAND
+#define GPIO_BITBAND(addr, bit) \
+    (*(volatile uint32_t *)(((uint32_t)(uintptr_t)(addr) & 0xF0000000UL) + 0x02000000UL + \
+                            (((uint32_t)(uintptr_t)(addr) & 0x000FFFFFUL) << 5) + ((uint32_t)(bit) << 2)))
+#endif
+
+#define GPIO_FIO_ADDR(port, off)  (GPIO_FIO_BASE + (port) * GPIO_FIO_STRIDE + (off))
+
+/**
+ * @brief Write one pin with a single atomic store (FIOSET/FIOCLR)
+ * @param pin Pin number (must be configured as OUTPUT)
+ * @param value GPIO_HIGH or GPIO_LOW
+ * @note FIOSET/FIOCLR only act on the 1 bits written, so a plain store
+ *       already changes just this pin. A bit-band alias would add a bus
+ *       read-modify-write for nothing. A FIOPIN alias would sample the
+ *       live pin levels instead, and a loaded output or one mid-transition
+ *       could be written wrong.
+ *       FIOSET/FIOCLR writes still honour FIOMASK, so do not use it from
+ *       an ISR that can preempt gpio_port_write_masked() on the same port.
+ */
+static inline void gpio_bb_write(uint8_t pin, gpio_state_t value) {
+    if (value == GPIO_HIGH) {
+        GPIO_FIOSET(GPIO_PORT_OF(pin)) = GPIO_MASK_OF(pin);
+    } else {
+        GPIO_FIOCLR(GPIO_PORT_OF(pin)) = GPIO_MASK_OF(pin);
+    }
+}
+
+/**
+ * @brief Read one pin through its bit-band alias
+ * @param pin Pin number
+ * @return GPIO_HIGH or GPIO_LOW
+ */
+static inline gpio_state_t gpio_bb_read(uint8_t pin) {
+    return (gpio_state_t)GPIO_BITBAND(GPIO_FIO_ADDR(GPIO_PORT_OF(pin), 0x14), pin & 0x1F);
+}
+
+/**
+ * @brief Set one pin's direction with a single atomic store (FIODIR alias)
+ * @param pin Pin number
+ * @param dir GPIO_INPUT or GPIO_OUTPUT
+ */
+static inline void gpio_bb_dir(uint8_t pin, gpio_dir_t dir) {
+    GPIO_BITBAND(GPIO_FIO_ADDR(GPIO_PORT_OF(pin), 0x00), pin & 0x1F) = dir;
+}
+
+// Route calls with compile-time constant pins/ports to the inline versions,
+// other calls still go to the out-of-line functions.
+// Define GPIO_NO_FAST_PATH before including this header to disable.
+#if defined(__GNUC__) && !defined(GPIO_NO_FAST_PATH)
+#define gpio_write(pin, value) \
+    (__builtin_constant_p(pin) ? gpio_write_fast(pin, value) : gpio_write(pin, value))
+#define gpio_read(pin) \
+    (__builtin_constant_p(pin) ? gpio_read_fast(pin) : gpio_read(pin))
+#define gpio_toggle(pin) \
+    (__builtin_constant_p(pin) ? gpio_toggle_fast(pin) : gpio_toggle(pin))
+#define gpio_port_write_masked(port, mask, value) \
+    (__builtin_constant_p(port) ? gpio_port_write_masked_fast(port, mask, value) \
+                                : gpio_port_write_masked(port, mask, value))
+#define gpio_port_read(port) \
+    (__builtin_constant_p(port) ? gpio_port_read_fast(port) : gpio_port_read(port))
+#endif
+
 /* ==================== Arduino-Style Aliases ==================== */
 #define pinMode(pin, mode)      gpio_config(pin, mode, GPIO_PULL_NONE)
 #define digitalWrite(pin, val)  gpio_write(pin, val)
@@ -0,0 +1,88 @@
+/**
+ * @file iap.c
+ * @brief In-Application Programming implementation
+ */
+
+#include "iap.h"
+#include "clock.h"
+#include "systick.h"
+#include <lpc17xx.h>
+
+/* ==================== IAP Commands ==================== */
+#define IAP_CMD_PREPARE     50
+#define IAP_CMD_COPY        51
+#define IAP_CMD_ERASE       52
+#define IAP_CMD_BLANK_CHECK 53
+#define IAP_CMD_COMPARE     56
+
+#define SMALL_SECTORS       16
+#define SMALL_SECTOR_SIZE   0x1000UL
+#define LARGE_SECTOR_SIZE   0x8000UL
+
+typedef void (*iap_entry_t)(uint32_t command[5], uint32_t result[5]);
+
+/* ==================== Helper Functions ==================== */
+
+// One ROM call with the flash unreadable: no interrupt may run meanwhile.
+// The ms ticks missed are added back before the pending interrupts run.
+static iap_status_t iap_call(uint32_t command[5]) {
+    uint32_t result[5];
+    uint32_t primask = __get_PRIMASK();  // Callers may hold a critical section
+
+    __disable_irq();
+    uint32_t start = cycles();
+    ((iap_entry_t)IAP_ENTRY_ADDR)(command, result);
+    systick_catch_up(cycles() - start);
+    __set_PRIMASK(primask);
+
+    return (iap_status_t)result[0];
+}
+
+static iap_status_t iap_prepare(uint8_t sector) {
+    uint32_t command[5] = { IAP_CMD_PREPARE, sector, sector };
+
+    return iap_call(command);
+}
+
+/* ==================== Public Functions ==================== */
+
+uint32_t iap_sector_addr(uint8_t sector) {
+    if(sector < SMALL_SECTORS) {
+        return sector * SMALL_SECTOR_SIZE;
+    }
+    return SMALL_SECTORS * SMALL_SECTOR_SIZE + (sector - SMALL_SECTORS) * LARGE_SECTOR_SIZE;
+}
+
+uint32_t iap_sector_size(uint8_t sector) {
+    return (sector < SMALL_SECTORS) ? SMALL_SECTOR_SIZE : LARGE_SECTOR_SIZE;
+}
+
+iap_status_t iap_erase(uint8_t sector) {
+    uint32_t command[5] = { IAP_CMD_ERASE, sector, sector, clock_get_cpu() / 1000 };
+    iap_status_t status = iap_prepare(sector);
+
+    return (status == IAP_OK) ? iap_call(command) : status;
+}
+
+iap_status_t iap_blank_check(uint8_t sector) {
+    uint32_t command[5] = { IAP_CMD_BLANK_CHECK, sector, sector };
+
+    return iap_call(command);
+}
+
+iap_status_t iap_program(uint32_t dst, const void *src, uint32_t len) {
+    uint8_t sector = (dst < SMALL_SECTORS * SMALL_SECTOR_SIZE)
+                   ? dst / SMALL_SECTOR_SIZE
+                   : SMALL_SECTORS + (dst - SMALL_SECTORS * SMALL_SECTOR_SIZE) / LARGE_SECTOR_SIZE;
+    uint32_t copy[5] = { IAP_CMD_COPY, dst, (uint32_t)(uintptr_t)src, len, clock_get_cpu() / 1000 };
+    uint32_t compare[5] = { IAP_CMD_COMPARE, dst, (uint32_t)(uintptr_t)src, len };
+    iap_status_t status = iap_prepare(sector);
+
+    if(status == IAP_OK) {
+        status = iap_call(copy);
+    }
+    if(status == IAP_OK) {
+        status = iap_call(compare);
+    }
+    return status;
+}
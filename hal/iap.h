@@ -0,0 +1,86 @@
+/**
+ * @file iap.h
+ * @brief In-Application Programming (flash erase/write) for LPC1768
+ * @note Wraps the boot ROM IAP entry. Flash cannot be read while it is
+ *       erased or written, so every call runs with interrupts disabled:
+ *       ~1 ms per 256-byte write, ~100 ms per sector erase. The ROM uses
+ *       the top 32 bytes of local RAM, keep them out of the stack/heap.
+ * @note Cost of the masked time: millis() is corrected afterwards (the
+ *       tick callbacks run once), PWM and timer match interrupts are late,
+ *       and a UART receiving faster than its 16-byte FIFO fills (~1.4 ms
+ *       at 115200 baud) loses bytes during an erase. Stop what cannot
+ *       wait first, see store_attach().
+ */
+
+#ifndef IAP_H
+#define IAP_H
+
+#include <stdint.h>
+
+/* ==================== Configuration ==================== */
+// Boot ROM entry point (Thumb), may be predefined for another backend
+#ifndef IAP_ENTRY_ADDR
+#define IAP_ENTRY_ADDR      0x1FFF1FF1UL
+#endif
+
+#define IAP_PAGE_SIZE       256   // Smallest write
+#define IAP_SECTORS         30    // 16 x 4 KB, then 14 x 32 KB
+
+/* ==================== Status Codes ==================== */
+// Boot ROM return codes
+typedef enum {
+    IAP_OK                = 0,
+    IAP_INVALID_COMMAND   = 1,
+    IAP_SRC_ADDR_ERROR    = 2,   // Not word aligned
+    IAP_DST_ADDR_ERROR    = 3,   // Not 256-byte aligned
+    IAP_SRC_NOT_MAPPED    = 4,
+    IAP_DST_NOT_MAPPED    = 5,
+    IAP_COUNT_ERROR       = 6,   // Not 256, 512, 1024 or 4096
+    IAP_INVALID_SECTOR    = 7,
+    IAP_SECTOR_NOT_BLANK  = 8,
+    IAP_NOT_PREPARED      = 9,
+    IAP_COMPARE_ERROR     = 10,
+    IAP_BUSY              = 11
+} iap_status_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Get the start address of a sector
+ * @param sector Sector 0 to IAP_SECTORS-1
+ */
+uint32_t iap_sector_addr(uint8_t sector);
+
+/**
+ * @brief Get the size of a sector
+ * @param sector Sector 0 to IAP_SECTORS-1
+ * @return 4096 or 32768 bytes
+ */
+uint32_t iap_sector_size(uint8_t sector);
+
+/**
+ * @brief Erase a sector (all bytes 0xFF)
+ * @param sector Sector number
+ * @return IAP_OK or the ROM error code
+ */
+iap_status_t iap_erase(uint8_t sector);
+
+/**
+ * @brief Check that a sector is erased
+ * @param sector Sector number
+ * @return IAP_OK if blank, IAP_SECTOR_NOT_BLANK otherwise
+ */
+iap_status_t iap_blank_check(uint8_t sector);
+
+/**
+ * @brief Write RAM to flash and verify it
+ * @param dst Flash address, 256-byte aligned
+ * @param src RAM buffer, word aligned
+ * @param len 256, 512, 1024 or 4096 bytes, within one sector
+ * @return IAP_OK, IAP_COMPARE_ERROR if the flash does not read back
+ * @note Each page may be written once between erases
+ * @example iap_program(addr, page, IAP_PAGE_SIZE);
+ */
+iap_status_t iap_program(uint32_t dst, const void *src, uint32_t len);
+
+#endif // IAP_H
@@ -0,0 +1,79 @@
+/**
+ * @file profile.c
+ * @brief Cycle-accurate code profiling implementation
+ */
+
+#include "profile.h"
+
+#if PROFILE_ENABLE
+
+#include <lpc17xx.h>
+
+static profile_probe_t probes[PROFILE_MAX_PROBES];
+static volatile uint32_t probe_count = 0;
+
+uint8_t profile_register(const char *name) {
+    uint32_t slot;
+
+    // Probes in different ISRs may register concurrently: claim atomically
+    do {
+        slot = __LDREXW(&probe_count);
+        if(slot >= PROFILE_MAX_PROBES) {
+            __CLREX();
+            return PROFILE_NO_SLOT;
+        }
+    } while(__STREXW(slot + 1, &probe_count));
+
+    // probe_count is claimed before the slot is filled: the name publishes
+    // it, readers skip slots without one
+    probes[slot].min = 0xFFFFFFFF;
+    __DMB();  // Slot filled before its name
+    probes[slot].name = name;
+    return (uint8_t)slot;
+}
+
+void profile_record(uint8_t slot, uint32_t cycles) {
+    if(slot >= PROFILE_MAX_PROBES) {
+        return;
+    }
+
+    profile_probe_t *p = &probes[slot];
+    p->count++;
+    p->total += cycles;
+    if(cycles < p->min) p->min = cycles;
+    if(cycles > p->max) p->max = cycles;
+}
+
+const profile_probe_t *profile_get(uint8_t slot) {
+    return (slot < probe_count && probes[slot].name) ? &probes[slot] : 0;
+}
+
+void profile_reset(void) {
+    for(uint8_t i = 0; i < probe_count; i++) {
+        probes[i].count = 0;
+        probes[i].total = 0;
+        probes[i].min = 0xFFFFFFFF;
+        probes[i].max = 0;
+    }
+}
+
+void profile_dump(uart_num_t uart) {
+    uint32_t per_us = cycles_per_us();
+
+    uart_printf(uart, "%-12s %8s %8s %8s %8s %6s\r\n",
+                "probe", "count", "min", "mean", "max", "max_us");
+
+    for(uint8_t i = 0; i < probe_count; i++) {
+        const profile_probe_t *p = &probes[i];
+        if(!p->name) {
+            continue;  // Claimed, still being registered
+        }
+        uint32_t mean = p->count ? (uint32_t)(p->total / p->count) : 0;
+        uint32_t min = p->count ? p->min : 0;
+
+        uart_printf(uart, "%-12s %8u %8u %8u %8u %6u\r\n",
+                    p->name, p->count, min, mean, p->max, p->max / per_us);
+    }
+}
+
+#endif // PROFILE_ENABLE
@@ -0,0 +1,109 @@
+/**
+ * @file profile.h
+ * @brief Cycle-accurate code profiling on the DWT cycle counter
+ * @note Named probes keep count/min/max/mean in a fixed table. Everything
+ *       compiles to nothing unless PROFILE_ENABLE is 1.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "systick.h"
+#include "uart.h"
+
+/* ==================== Configuration ==================== */
+// Set to 1 (e.g., -DPROFILE_ENABLE=1) to build the probes in
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE      0
+#endif
+
+// Probe table size
+#ifndef PROFILE_MAX_PROBES
+#define PROFILE_MAX_PROBES  16
+#endif
+
+#define PROFILE_NO_SLOT     0xFF  // Table full or not yet registered
+
+/* ==================== Types ==================== */
+typedef struct {
+    const char *volatile name;  // Set last, publishes the slot
+    uint32_t count;    // Completed enter/exit pairs
+    uint32_t min;      // Cycles
+    uint32_t max;
+    uint64_t total;    // For the mean
+} profile_probe_t;
+
+/* ==================== Probe Macros ==================== */
+#if PROFILE_ENABLE
+
+/**
+ * @brief Start timing a named probe (a statement, once per scope)
+ * @param name Identifier, also the name shown by profile_dump()
+ * @example PROFILE_ENTER(refresh); ... PROFILE_EXIT(refresh);
+ * @note A probe must only be entered from one context (ISR or main)
+ */
+#define PROFILE_ENTER(name)                                             \
+    static uint8_t profile_slot_##name = PROFILE_NO_SLOT;               \
+    if(profile_slot_##name == PROFILE_NO_SLOT)                          \
+        profile_slot_##name = profile_register(#name);                  \
+    uint32_t profile_start_##name = cycles()
+
+/**
+ * @brief Stop timing a named probe and record the cycles spent
+ * @param name Same identifier as PROFILE_ENTER
+ */
+#define PROFILE_EXIT(name) \
+    profile_record(profile_slot_##name, cycles() - profile_start_##name)
+
+#else
+
+#define PROFILE_ENTER(name)  do { } while(0)
+#define PROFILE_EXIT(name)   do { } while(0)
+
+#endif
+
+/* ==================== Functions ==================== */
+#if PROFILE_ENABLE
+
+/**
+ * @brief Claim a table slot for a probe (used by PROFILE_ENTER)
+ * @param name Probe name (string literal)
+ * @return Slot index, PROFILE_NO_SLOT if the table is full
+ */
+uint8_t profile_register(const char *name);
+
+/**
+ * @brief Add one measurement to a probe (used by PROFILE_EXIT)
+ * @param slot Slot from profile_register()
+ * @param cycles Cycles spent
+ */
+void profile_record(uint8_t slot, uint32_t cycles);
+
+/**
+ * @brief Get a probe's statistics
+ * @param slot Slot index 0..PROFILE_MAX_PROBES-1
+ * @return Probe entry, NULL if the slot is unused
+ */
+const profile_probe_t *profile_get(uint8_t slot);
+
+/**
+ * @brief Clear all statistics (probes stay registered)
+ */
+void profile_reset(void);
+
+/**
+ * @brief Print the probe table (name, count, min/mean/max cycles and us)
+ * @param uart UART to print on (non-blocking TX ring)
+ * @example profile_dump(UART_0);
+ */
+void profile_dump(uart_num_t uart);
+
+#else
+
+#define profile_reset()      do { } while(0)
+#define profile_dump(uart)   do { (void)(uart); } while(0)
+
+#endif
+
+#endif // PROFILE_H
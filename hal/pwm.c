@@ -0,0 +1,164 @@
+/**
+ * @file pwm.c
+ * @brief PWM1 HAL implementation
+ */
+
+#include "pwm.h"
+#include "gpio.h"
+#include "clock.h"
+#include "diag.h"
+#include <lpc17xx.h>
+
+/* ==================== Register Bits ==================== */
+#define PCONP_PCPWM1        (1 << 6)
+#define TCR_ENABLE          (1 << 0)
+#define TCR_RESET           (1 << 1)
+#define TCR_PWM_ENABLE      (1 << 3)
+#define MCR_MR0R            (1 << 1)   // Reset TC on MR0 (period)
+#define PCR_PWMENA(ch)      (1UL << (8 + (ch)))
+
+// PWM1.1-PWM1.6 are P2.0-P2.5, PINSEL function 1
+#define PWM_PIN(ch)         GPIO_PIN(2, ((ch) - 1))
+#define PWM_PIN_FUNC        1
+
+// IR bit for each match register (MR4-MR6 sit above the capture bits)
+static const uint8_t match_ir_bit[7] = { 0, 1, 2, 3, 8, 9, 10 };
+
+/* ==================== Driver State ==================== */
+static volatile pwm_callback_t pwm_callbacks[7];
+static uint32_t period_ticks;
+static uint32_t period_hz;
+
+/* ==================== Helper Functions ==================== */
+
+static volatile uint32_t *get_match_reg(uint8_t match) {
+    // MR0-MR3 and MR4-MR6 are two separate consecutive blocks
+    return (match < 4) ? &LPC_PWM1->MR0 + match : &LPC_PWM1->MR4 + (match - 4);
+}
+
+// Clock change callback: same period and duty cycles at the new rate
+static void pwm_clock_changed(uint32_t cpu_hz) {
+    (void)cpu_hz;
+    uint32_t old_ticks = period_ticks;
+
+    period_ticks = clock_get_pclk(CLOCK_PCLK_PWM1) / period_hz;
+    LPC_PWM1->MR0 = period_ticks;
+    for(uint8_t match = 1; match <= PWM_CHANNELS; match++) {
+        volatile uint32_t *mr = get_match_reg(match);
+        *mr = (uint32_t)(((uint64_t)*mr * period_ticks) / old_ticks);
+    }
+    LPC_PWM1->LER = 0x7F;
+}
+
+#if DIAG_ENABLE
+// Cycles since the earliest pending match (TC counts CCLK, MR0 resets it)
+static uint32_t pwm_irq_late(uint32_t pending) {
+    uint32_t tc = LPC_PWM1->TC;
+    uint32_t late = 0;
+
+    for(uint8_t match = 0; match < 7; match++) {
+        if(pending & (1UL << match_ir_bit[match])) {
+            uint32_t at = (match == 0) ? 0 : *get_match_reg(match);
+            uint32_t since = (tc >= at) ? tc - at : tc + period_ticks - at;
+            if(since > late) {
+                late = since;
+            }
+        }
+    }
+    return late;
+}
+#endif
+
+/* ==================== Interrupt Handler ==================== */
+
+void PWM1_IRQHandler(void) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_PWM1, pwm_irq_late(LPC_PWM1->IR));
+    uint32_t pending = LPC_PWM1->IR;
+
+    LPC_PWM1->IR = pending;  // Write 1 to clear
+
+    for(uint8_t match = 0; match < 7; match++) {
+        if(pending & (1UL << match_ir_bit[match])) {
+            pwm_callback_t callback = pwm_callbacks[match];
+            if(callback) {
+                callback(match);
+            }
+        }
+    }
+    DIAG_IRQ_EXIT(DIAG_IRQ_PWM1);
+}
+
+/* ==================== Public Functions ==================== */
+
+void pwm_init(uint32_t freq_hz) {
+    // 1. Power on PWM1, clock it from CCLK and follow CPU clock changes
+    LPC_SC->PCONP |= PCONP_PCPWM1;
+    clock_set_pclk(CLOCK_PCLK_PWM1, 1);
+    if(period_hz == 0) {
+        clock_attach(pwm_clock_changed);
+    }
+
+    // 2. Period on MR0, all channels single-edge at 0%
+    LPC_PWM1->TCR = TCR_RESET;
+    LPC_PWM1->PR = 0;
+    period_hz = freq_hz;
+    period_ticks = clock_get_pclk(CLOCK_PCLK_PWM1) / freq_hz;
+    LPC_PWM1->MR0 = period_ticks;
+    for(uint8_t match = 1; match <= PWM_CHANNELS; match++) {
+        *get_match_reg(match) = 0;
+    }
+    LPC_PWM1->MCR = MCR_MR0R;
+    LPC_PWM1->PCR = 0;
+    LPC_PWM1->LER = 0x7F;
+    LPC_PWM1->IR = 0x73F;
+
+    // 3. Start in PWM mode
+    NVIC_EnableIRQ(PWM1_IRQn);
+    LPC_PWM1->TCR = TCR_ENABLE | TCR_PWM_ENABLE;
+}
+
+void pwm_enable(uint8_t channel) {
+    const gpio_pin_cfg_t pin = { PWM_PIN(channel), PWM_PIN_FUNC, GPIO_OUTPUT, GPIO_PULL_NONE, GPIO_LOW };
+
+    gpio_config_table(&pin, 1);
+    LPC_PWM1->PCR |= PCR_PWMENA(channel);
+}
+
+void pwm_disable(uint8_t channel, gpio_state_t idle) {
+    const gpio_pin_cfg_t pin = GPIO_CFG_OUT(PWM_PIN(channel), idle);
+
+    // Pin to GPIO first, so it goes straight from the PWM output to idle
+    gpio_config_table(&pin, 1);
+    LPC_PWM1->PCR &= ~PCR_PWMENA(channel);
+}
+
+uint32_t pwm_period_ticks(void) {
+    return period_ticks;
+}
+
+void pwm_set_ticks(uint8_t match, uint32_t ticks) {
+    // Above MR0 the reset never happens, output stays high
+    if(ticks > period_ticks) {
+        ticks = period_ticks + 1;
+    }
+    *get_match_reg(match) = ticks;
+    LPC_PWM1->LER |= 1UL << match;  // Latch at next period start
+}
+
+void pwm_set_duty(uint8_t channel, uint16_t permille) {
+    if(permille > PWM_DUTY_MAX) {
+        permille = PWM_DUTY_MAX;
+    }
+    pwm_set_ticks(channel, (uint32_t)(((uint64_t)period_ticks * permille) / PWM_DUTY_MAX));
+}
+
+void pwm_attach(uint8_t match, pwm_callback_t callback) {
+    pwm_callbacks[match] = callback;
+
+    if(callback) {
+        LPC_PWM1->IR = 1UL << match_ir_bit[match];
+        LPC_PWM1->MCR |= 1UL << (match * 3);   // MRnI
+    } else {
+        LPC_PWM1->MCR &= ~(1UL << (match * 3));
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * @file pwm.h
+ * @brief PWM1 HAL for LPC1768 (single-edge, six channels)
+ * @note MR0 sets the period, MR1-MR6 set the duty of PWM1.1-PWM1.6
+ */
+
+#ifndef PWM_H
+#define PWM_H
+
+#include <stdint.h>
+#include "gpio.h"
+
+/* ==================== Configuration ==================== */
+#define PWM_CHANNELS    6     // PWM1.1 - PWM1.6 on P2.0 - P2.5
+#define PWM_DUTY_MAX    1000  // Duty is given in permille
+
+/* ==================== Types ==================== */
+// Called from PWM1_IRQHandler when match register 0-6 fires
+typedef void (*pwm_callback_t)(uint8_t match);
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Power on PWM1 and start the period counter
+ * @param freq_hz PWM period frequency in Hz
+ * @note All channels start at 0% duty with their outputs disabled.
+ *       Clocked from CCLK, period and duties follow clock_set_cpu() changes.
+ * @example pwm_init(20000);  // 20 kHz
+ */
+void pwm_init(uint32_t freq_hz);
+
+/**
+ * @brief Route a channel to its pin (P2.0 + channel - 1) and enable the output
+ * @param channel PWM channel 1-6
+ */
+void pwm_enable(uint8_t channel);
+
+/**
+ * @brief Disable a channel output (pin returns to GPIO)
+ * @param channel PWM channel 1-6
+ * @param idle Level the pin is driven at from then on
+ */
+void pwm_disable(uint8_t channel, gpio_state_t idle);
+
+/**
+ * @brief Counter ticks per PWM period
+ * @note Changes with the CPU clock
+ */
+uint32_t pwm_period_ticks(void);
+
+/**
+ * @brief Set a match value in counter ticks
+ * @param match Match register 1-6
+ * @param ticks 0 = always low, >= pwm_period_ticks() = always high
+ * @note Takes effect at the start of the next period (latched, glitch-free)
+ */
+void pwm_set_ticks(uint8_t match, uint32_t ticks);
+
+/**
+ * @brief Set channel duty cycle
+ * @param channel PWM channel 1-6
+ * @param permille Duty 0-PWM_DUTY_MAX
+ * @example pwm_set_duty(1, 250);  // 25%
+ */
+void pwm_set_duty(uint8_t channel, uint16_t permille);
+
+/**
+ * @brief Call a function when a match register fires
+ * @param match Match register 0-6 (0 = start of each period)
+ * @param callback Function to call, NULL disables the interrupt
+ */
+void pwm_attach(uint8_t match, pwm_callback_t callback);
+
+#endif // PWM_H
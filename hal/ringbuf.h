@@ -0,0 +1,192 @@
+/**
+ * @file ringbuf.h
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * @note One context (e.g. an ISR) may only put, one other (e.g. main) may
+ *       only get. No interrupts are disabled, ordering is kept with DMB.
+ */
+
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <lpc17xx.h>
+
+/* ==================== Ring Buffer ==================== */
+// head/tail are free-running counters: count = head - tail, index = n & mask.
+// Only the producer writes head and only the consumer writes tail, so each
+// side owns one word and a single aligned store publishes it.
+typedef struct {
+    uint8_t *buf;              // Storage (count * elem_size bytes)
+    uint16_t elem_size;        // Bytes per element
+    uint16_t mask;             // count - 1 (count must be a power of 2)
+    volatile uint32_t head;    // Next slot to write (producer only)
+    volatile uint32_t tail;    // Next slot to read (consumer only)
+} ringbuf_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Initialize ring buffer over caller-provided storage
+ * @param rb Ring buffer
+ * @param storage Buffer of count * elem_size bytes
+ * @param elem_size Size of one element in bytes
+ * @param count Number of elements (power of 2)
+ * @example static uint8_t rx[64]; ringbuf_init(&rb, rx, 1, sizeof(rx));
+ */
+static inline void ringbuf_init(ringbuf_t *rb, void *storage, uint16_t elem_size, uint16_t count) {
+    rb->buf = (uint8_t *)storage;
+    rb->elem_size = elem_size;
+    rb->mask = count - 1;
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+/**
+ * @brief Number of elements waiting to be read
+ */
+static inline uint32_t ringbuf_count(const ringbuf_t *rb) {
+    return rb->head - rb->tail;
+}
+
+/**
+ * @brief Number of free slots
+ */
+static inline uint32_t ringbuf_space(const ringbuf_t *rb) {
+    return (uint32_t)rb->mask + 1 - (rb->head - rb->tail);
+}
+
+/**
+ * @brief Check if ring buffer is empty
+ */
+static inline bool ringbuf_empty(const ringbuf_t *rb) {
+    return rb->head == rb->tail;
+}
+
+/**
+ * @brief Append one element (producer side)
+ * @param rb Ring buffer
+ * @param elem Pointer to elem_size bytes
+ * @return true if stored, false if full
+ */
+static inline bool ringbuf_put(ringbuf_t *rb, const void *elem) {
+    uint32_t head = rb->head;
+
+    if (head - rb->tail > rb->mask) {
+        return false;  // Full
+    }
+
+    const uint8_t *src = (const uint8_t *)elem;
+    uint8_t *dst = &rb->buf[(head & rb->mask) * rb->elem_size];
+    for (uint16_t i = 0; i < rb->elem_size; i++) {
+        dst[i] = src[i];
+    }
+
+    __DMB();  // Data must be visible before the new head
+    rb->head = head + 1;
+    return true;
+}
+
+/**
+ * @brief Remove one element (consumer side)
+ * @param rb Ring buffer
+ * @param elem Filled with elem_size bytes
+ * @return true if read, false if empty
+ */
+static inline bool ringbuf_get(ringbuf_t *rb, void *elem) {
+    uint32_t tail = rb->tail;
+
+    if (tail == rb->head) {
+        return false;  // Empty
+    }
+
+    __DMB();  // Read head before the data it publishes
+
+    const uint8_t *src = &rb->buf[(tail & rb->mask) * rb->elem_size];
+    uint8_t *dst = (uint8_t *)elem;
+    for (uint16_t i = 0; i < rb->elem_size; i++) {
+        dst[i] = src[i];
+    }
+
+    __DMB();  // Finish reading the slot before releasing it
+    rb->tail = tail + 1;
+    return true;
+}
+
+/**
+ * @brief Get the oldest element without removing it (consumer side)
+ * @param rb Ring buffer
+ * @return Pointer into the buffer, NULL if empty. Valid until ringbuf_skip()
+ */
+static inline void *ringbuf_peek(ringbuf_t *rb) {
+    uint32_t tail = rb->tail;
+
+    if (tail == rb->head) {
+        return NULL;
+    }
+
+    __DMB();
+    return &rb->buf[(tail & rb->mask) * rb->elem_size];
+}
+
+/**
+ * @brief Drop the oldest element (consumer side, after ringbuf_peek())
+ * @param rb Ring buffer (must not be empty)
+ */
+static inline void ringbuf_skip(ringbuf_t *rb) {
+    __DMB();
+    rb->tail = rb->tail + 1;
+}
+
+/**
+ * @brief Append up to len bytes (producer side, byte buffers only)
+ * @param rb Ring buffer with elem_size == 1
+ * @param data Bytes to write
+ * @param len Number of bytes
+ * @return Number of bytes stored
+ */
+static inline size_t ringbuf_write(ringbuf_t *rb, const uint8_t *data, size_t len) {
+    uint32_t head = rb->head;
+    uint32_t space = (uint32_t)rb->mask + 1 - (head - rb->tail);
+
+    if (len > space) {
+        len = space;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        rb->buf[(head + i) & rb->mask] = data[i];
+    }
+
+    __DMB();
+    rb->head = head + len;
+    return len;
+}
+
+/**
+ * @brief Remove up to len bytes (consumer side, byte buffers only)
+ * @param rb Ring buffer with elem_size == 1
+ * @param data Destination buffer
+ * @param len Maximum number of bytes
+ * @return Number of bytes read
+ */
+static inline size_t ringbuf_read(ringbuf_t *rb, uint8_t *data, size_t len) {
+    uint32_t tail = rb->tail;
+    uint32_t avail = rb->head - tail;
+
+    if (len > avail) {
+        len = avail;
+    }
+
+    __DMB();
+
+    for (size_t i = 0; i < len; i++) {
+        data[i] = rb->buf[(tail + i) & rb->mask];
+    }
+
+    __DMB();
+    rb->tail = tail + len;
+    return len;
+}
+
+#endif // RINGBUF_H
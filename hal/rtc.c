@@ -0,0 +1,126 @@
+/**
+ * @file rtc.c
+ * @brief Real-time clock HAL implementation
+ */
+
+#include "rtc.h"
+#include "diag.h"
+#include <lpc17xx.h>
+
+/* ==================== Register Bits ==================== */
+#define PCONP_PCRTC     (1 << 9)
+#define CCR_CLKEN       (1 << 0)     // Time counters enabled
+#define CCR_CTCRST      (1 << 1)     // Hold the sub-second divider in reset
+#define CCR_CCALEN      (1 << 4)     // 1 = calibration counter disabled
+#define ILR_RTCCIF      (1 << 0)     // Counter increment interrupt
+#define ILR_RTCALF      (1 << 1)     // Alarm interrupt
+#define CIIR_IMSEC      (1 << 0)     // Interrupt on each second
+#define AMR_ALL         0xFF         // Every alarm field masked (off)
+#define AMR_HMS         0xF8         // Compare hour, minute, second only
+
+// Consolidated time registers
+#define CTIME0_SEC(r)   ((r) & 0x3F)
+#define CTIME0_MIN(r)   (((r) >> 8) & 0x3F)
+#define CTIME0_HOUR(r)  (((r) >> 16) & 0x1F)
+#define CTIME1_YEAR(r)  (((r) >> 16) & 0xFFF)
+#define CTIME2_DOY(r)   ((r) & 0xFFF)
+
+#define SECONDS_PER_DAY 86400UL
+
+/* ==================== Driver State ==================== */
+static volatile rtc_callback_t second_callback = 0;
+static volatile rtc_callback_t alarm_callback = 0;
+
+/* ==================== Interrupt Handler ==================== */
+
+void RTC_IRQHandler(void) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_RTC, DIAG_NO_LATENCY);  // No sub-second counter to measure against
+    uint32_t flags = LPC_RTC->ILR;
+
+    LPC_RTC->ILR = flags;  // Write 1 to clear
+
+    if((flags & ILR_RTCCIF) && second_callback) {
+        second_callback();
+    }
+    if(flags & ILR_RTCALF) {
+        rtc_callback_t callback = alarm_callback;
+
+        LPC_RTC->AMR = AMR_ALL;  // One-shot
+        alarm_callback = 0;
+        if(callback) {
+            callback();
+        }
+    }
+    DIAG_IRQ_EXIT(DIAG_IRQ_RTC);
+}
+
+/* ==================== Public Functions ==================== */
+
+void rtc_init(void) {
+    LPC_SC->PCONP |= PCONP_PCRTC;
+
+    // 1. Stop and reset the counters, year 0 day 1 00:00:00
+    LPC_RTC->CCR = CCR_CTCRST | CCR_CCALEN;
+    LPC_RTC->CIIR = 0;
+    LPC_RTC->AMR = AMR_ALL;
+    LPC_RTC->ILR = ILR_RTCCIF | ILR_RTCALF;
+    LPC_RTC->SEC = 0;
+    LPC_RTC->MIN = 0;
+    LPC_RTC->HOUR = 0;
+    LPC_RTC->DOM = 1;
+    LPC_RTC->DOW = 0;
+    LPC_RTC->DOY = 1;
+    LPC_RTC->MONTH = 1;
+    LPC_RTC->YEAR = 0;
+    LPC_RTC->CALIBRATION = 0;
+
+    // 2. Count, interrupts are enabled per source
+    LPC_RTC->CCR = CCR_CLKEN | CCR_CCALEN;
+    NVIC_EnableIRQ(RTC_IRQn);
+}
+
+uint32_t rtc_now(void) {
+    uint32_t t0, t1, t2;
+
+    // Consistent snapshot: retry if a second ticked between the reads
+    do {
+        t0 = LPC_RTC->CTIME0;
+        t1 = LPC_RTC->CTIME1;
+        t2 = LPC_RTC->CTIME2;
+    } while(t0 != LPC_RTC->CTIME0);
+
+    // Year 0 is a leap year, then every fourth
+    uint32_t year = CTIME1_YEAR(t1);
+    uint32_t days = year * 365 + (year + 3) / 4 + CTIME2_DOY(t2) - 1;
+
+    return ((days * 24 + CTIME0_HOUR(t0)) * 60 + CTIME0_MIN(t0)) * 60 + CTIME0_SEC(t0);
+}
+
+void rtc_restart_second(void) {
+    LPC_RTC->CCR = CCR_CLKEN | CCR_CCALEN | CCR_CTCRST;
+    LPC_RTC->CCR = CCR_CLKEN | CCR_CCALEN;
+}
+
+void rtc_on_second(rtc_callback_t callback) {
+    second_callback = callback;
+    LPC_RTC->CIIR = callback ? CIIR_IMSEC : 0;
+}
+
+void rtc_set_alarm(uint32_t delay_s, rtc_callback_t callback) {
+    // Days count from midnight, so the time of day of the target is exact
+    uint32_t at = (rtc_now() + delay_s) % SECONDS_PER_DAY;
+
+    LPC_RTC->AMR = AMR_ALL;
+    alarm_callback = callback;
+    LPC_RTC->ALSEC = at % 60;
+    LPC_RTC->ALMIN = (at / 60) % 60;
+    LPC_RTC->ALHOUR = at / 3600;
+    LPC_RTC->ILR = ILR_RTCALF;
+    LPC_RTC->AMR = AMR_HMS;
+}
+
+void rtc_clear_alarm(void) {
+    LPC_RTC->AMR = AMR_ALL;
+    LPC_RTC->ILR = ILR_RTCALF;
+    alarm_callback = 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file rtc.h
+ * @brief Real-time clock HAL for LPC1768 (32.768 kHz, runs in Deep-sleep)
+ * @note Used as a drift-free seconds counter, not as a calendar: the time
+ *       registers start from zero at rtc_init() and rtc_now() counts
+ *       seconds from there.
+ */
+
+#ifndef RTC_H
+#define RTC_H
+
+#include <stdint.h>
+
+/* ==================== Configuration ==================== */
+// Longest rtc_set_alarm() delay: the alarm compares hours/minutes/seconds
+#define RTC_ALARM_MAX_S     86399UL
+
+/* ==================== Types ==================== */
+// Called from RTC_IRQHandler
+typedef void (*rtc_callback_t)(void);
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Power on the RTC and start counting from zero
+ * @note Needs the 32.768 kHz crystal on RTCX1/RTCX2
+ * @example rtc_init();
+ */
+void rtc_init(void);
+
+/**
+ * @brief Get seconds counted since rtc_init()
+ * @return Seconds (monotonic, wraps after ~136 years)
+ */
+uint32_t rtc_now(void);
+
+/**
+ * @brief Restart the current second
+ * @note The next increment (and rtc_on_second() callback) comes a full
+ *       second from now. The dropped part of a second is lost from rtc_now().
+ */
+void rtc_restart_second(void);
+
+/**
+ * @brief Call a function on every seconds increment
+ * @param callback Function, NULL disables the interrupt
+ * @note Wakes the CPU from Deep-sleep once per second while enabled
+ * @example rtc_on_second(count_second);
+ */
+void rtc_on_second(rtc_callback_t callback);
+
+/**
+ * @brief Call a function once, delay_s seconds after the current second
+ * @param delay_s Seconds from now, 1 to RTC_ALARM_MAX_S
+ * @param callback One-shot alarm function (wakes from Deep-sleep)
+ * @example rtc_set_alarm(60, wake_up);
+ */
+void rtc_set_alarm(uint32_t delay_s, rtc_callback_t callback);
+
+/**
+ * @brief Cancel a pending alarm
+ */
+void rtc_clear_alarm(void);
+
+#endif // RTC_H
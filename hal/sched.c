@@ -0,0 +1,147 @@
+/**
+ * @file sched.c
+ * @brief Cooperative run-to-completion task scheduler implementation
+ */
+
+#include "sched.h"
+#include "systick.h"
+#include <lpc17xx.h>
+
+static sched_task_t *task_list = 0;  // Sorted by priority, main loop only
+static sched_idle_t idle_hook = systick_idle;
+
+/* ==================== Helper Functions ==================== */
+
+// Periodic release from the timer wheel (SysTick context)
+static void release_from_timer(void *arg) {
+    sched_post((sched_task_t *)arg);
+}
+
+// a before b: higher priority, then earlier absolute deadline
+static bool runs_before(const sched_task_t *a, const sched_task_t *b) {
+    if(a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+    if(a->deadline_ms == SCHED_NO_DEADLINE) {
+        return false;
+    }
+    if(b->deadline_ms == SCHED_NO_DEADLINE) {
+        return true;
+    }
+    uint32_t a_due = a->release + a->deadline_ms * 1000;
+    uint32_t b_due = b->release + b->deadline_ms * 1000;
+    return (int32_t)(a_due - b_due) < 0;
+}
+
+static sched_task_t *find_next(void) {
+    sched_task_t *best = 0;
+
+    for(sched_task_t *t = task_list; t; t = t->next) {
+        if(!t->pending) {
+            continue;
+        }
+        if(best && best->priority < t->priority) {
+            break;  // Sorted list: nothing further can win
+        }
+        if(!best || runs_before(t, best)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+/* ==================== Public Functions ==================== */
+
+void sched_add(sched_task_t *task, sched_task_fn_t fn, void *arg,
+               uint8_t priority, uint32_t deadline_ms) {
+    sched_task_t **link = &task_list;
+
+    task->fn = fn;
+    task->arg = arg;
+    task->priority = priority;
+    task->deadline_ms = deadline_ms;
+    task->pending = 0;
+    task->runs = 0;
+    task->misses = 0;
+    task->max_latency_us = 0;
+    swtimer_setup(&task->timer, release_from_timer, task, SWTIMER_ISR);
+
+    // Insert after tasks of equal priority (registration order)
+    while(*link && (*link)->priority <= priority) {
+        link = &(*link)->next;
+    }
+    task->next = *link;
+    *link = task;
+}
+
+void sched_post(sched_task_t *task) {
+    if(task->pending) {
+        return;  // Keep the oldest release time
+    }
+    task->release = micros();
+    __DMB();  // Release time visible before the flag
+    task->pending = 1;
+}
+
+void sched_every(sched_task_t *task, uint32_t period_ms) {
+    if(task->deadline_ms == SCHED_NO_DEADLINE) {
+        task->deadline_ms = period_ms;  // Implicit deadline: next release
+    }
+    swtimer_start(&task->timer, period_ms, period_ms);
+}
+
+void sched_stop(sched_task_t *task) {
+    swtimer_stop(&task->timer);
+    task->pending = 0;
+}
+
+void sched_set_idle(sched_idle_t idle) {
+    idle_hook = idle;
+}
+
+bool sched_run_once(void) {
+    sched_task_t *t = find_next();
+
+    if(!t) {
+        return false;
+    }
+
+    // Clear first: a release while it runs makes it run again
+    uint32_t release = t->release;
+    t->pending = 0;
+    __DMB();
+
+    uint32_t latency = micros() - release;
+    if(latency > t->max_latency_us) {
+        t->max_latency_us = latency;
+    }
+    if(t->deadline_ms != SCHED_NO_DEADLINE && latency > t->deadline_ms * 1000) {
+        t->misses++;
+    }
+
+    t->fn(t->arg);
+    t->runs++;
+    return true;
+}
+
+void sched_run(void) {
+    while(1) {
+        swtimer_run();
+
+        if(sched_run_once()) {
+            continue;
+        }
+
+        // Check and sleep with interrupts masked so a release between the
+        // two cannot be slept through (a pending IRQ still ends WFI)
+        __disable_irq();
+        if(!find_next()) {
+            idle_hook();
+        }
+        __enable_irq();
+    }
+}
+
+sched_task_t *sched_tasks(void) {
+    return task_list;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file sched.h
+ * @brief Cooperative run-to-completion task scheduler
+ * @note Tasks are released from any context with sched_post() or
+ *       periodically by a software timer. The highest-priority released
+ *       task runs next (earliest deadline first within a priority), and
+ *       the idle hook sleeps when nothing is released.
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "swtimer.h"
+
+/* ==================== Configuration ==================== */
+#define SCHED_PRIO_HIGHEST  0    // Lower number = higher priority
+#define SCHED_NO_DEADLINE   0    // Task has no deadline
+
+/* ==================== Types ==================== */
+typedef void (*sched_task_fn_t)(void *arg);
+
+// Called with interrupts masked when no task is released, must return on
+// any interrupt (WFI does, even while masked)
+typedef void (*sched_idle_t)(void);
+
+typedef struct sched_task {
+    struct sched_task *next;     // Priority-ordered task list
+    sched_task_fn_t fn;
+    void *arg;
+    uint8_t priority;            // SCHED_PRIO_HIGHEST = 0
+    volatile uint8_t pending;    // Released, waiting to run
+    uint32_t deadline_ms;        // Relative to release, SCHED_NO_DEADLINE = none
+    volatile uint32_t release;   // micros() of the oldest unserved release
+    swtimer_t timer;             // Periodic release (sched_every)
+    
+    // Statistics (main loop only)
+    uint32_t runs;               // Completed runs
+    uint32_t misses;             // Runs started after their deadline
+    uint32_t max_latency_us;     // Worst release-to-start time
+} sched_task_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Register a task (not released)
+ * @param task Task (static storage)
+ * @param fn Function run to completion on each release
+ * @param arg Passed to fn
+ * @param priority 0 = highest
+ * @param deadline_ms Release-to-start deadline, SCHED_NO_DEADLINE for none
+ * @example sched_add(&input_task, process_events, 0, 0, 5);
+ */
+void sched_add(sched_task_t *task, sched_task_fn_t fn, void *arg,
+               uint8_t priority, uint32_t deadline_ms);
+
+/**
+ * @brief Release a task (ISR-safe)
+ * @param task Task to run; several releases before it runs coalesce into one
+ */
+void sched_post(sched_task_t *task);
+
+/**
+ * @brief Release a task every period_ms, the first release one period from now
+ * @param task Task registered with sched_add()
+ * @param period_ms Release interval
+ * @note Call from main. A deadline of SCHED_NO_DEADLINE becomes period_ms.
+ */
+void sched_every(sched_task_t *task, uint32_t period_ms);
+
+/**
+ * @brief Cancel periodic releases and any pending release
+ * @param task Task to stop
+ */
+void sched_stop(sched_task_t *task);
+
+/**
+ * @brief Replace the idle hook (default systick_idle)
+ * @param idle Hook, called with interrupts masked
+ */
+void sched_set_idle(sched_idle_t idle);
+
+/**
+ * @brief Run the best released task, if any
+ * @return true if a task ran
+ */
+bool sched_run_once(void);
+
+/**
+ * @brief Scheduler main loop (never returns)
+ * @note Also runs SWTIMER_DEFERRED callbacks (swtimer_run) between tasks
+ */
+void sched_run(void);
+
+/**
+ * @brief Get the first task of the priority-ordered list (for statistics)
+ * @example for(sched_task_t *t = sched_tasks(); t; t = t->next) { ... }
+ */
+sched_task_t *sched_tasks(void);
+
+#endif // SCHED_H
@@ -0,0 +1,358 @@
+/**
+ * @file ssp.c
+ * @brief SSP (SPI master) HAL implementation
+ */
+
+#include "ssp.h"
+#include "gpio.h"
+#include "clock.h"
+#include "dma.h"
+#include "diag.h"
+#include <lpc17xx.h>
+
+/* ==================== Register Bits ==================== */
+#define CR0_DSS(bits)   ((bits) - 1)        // Data size select
+#define CR0_CPOL        (1 << 6)
+#define CR0_CPHA        (1 << 7)
+#define CR0_SCR(n)      ((uint32_t)(n) << 8) // Serial clock rate
+#define CR0_SCR_MASK    (0xFFUL << 8)
+#define CR1_SSE         (1 << 1)            // SSP enable
+#define SR_TNF          (1 << 1)            // TX FIFO not full
+#define SR_RNE          (1 << 2)            // RX FIFO not empty
+#define SR_BSY          (1 << 4)            // Frame shifting or TX FIFO not empty
+#define IMSC_RTIM       (1 << 1)            // RX timeout (frames left unread)
+#define IMSC_RXIM       (1 << 2)            // RX FIFO half full
+#define ICR_RTIC        (1 << 1)
+#define DMACR_RXDMAE    (1 << 0)
+#define DMACR_TXDMAE    (1 << 1)
+
+#define CPSR_MAX        254                 // Even, 2-254
+#define SCR_MAX         255
+
+/* ==================== Pin Maps ==================== */
+// SCK, SSEL, MISO and MOSI on function 2
+static const gpio_pin_cfg_t ssp0_pins[] = {
+    { P0_15, 2, GPIO_OUTPUT, GPIO_PULL_NONE, GPIO_LOW },
+    { P0_16, 2, GPIO_OUTPUT, GPIO_PULL_NONE, GPIO_LOW },
+    { P0_17, 2, GPIO_INPUT,  GPIO_PULL_UP,   GPIO_LOW },
+    { P0_18, 2, GPIO_OUTPUT, GPIO_PULL_NONE, GPIO_LOW }
+};
+
+static const gpio_pin_cfg_t ssp1_pins[] = {
+    { P0_7, 2, GPIO_OUTPUT, GPIO_PULL_NONE, GPIO_LOW },
+    { P0_6, 2, GPIO_OUTPUT, GPIO_PULL_NONE, GPIO_LOW },
+    { P0_8, 2, GPIO_INPUT,  GPIO_PULL_UP,   GPIO_LOW },
+    { P0_9, 2, GPIO_OUTPUT, GPIO_PULL_NONE, GPIO_LOW }
+};
+
+/* ==================== Driver State ==================== */
+typedef struct {
+    ssp_xfer_t *head;               // Running transfer
+    ssp_xfer_t *tail;
+    uint16_t tx_pos;                // Frames written to the FIFO / DMA
+    uint16_t rx_pos;                // Frames received
+    uint16_t chunk;                 // Frames in the running DMA chunk
+    bool wide;                      // Frames over 8 bits (halfword buffers)
+    uint32_t hz;                    // Requested rate, 0 = not initialized
+} ssp_port_t;
+
+static ssp_port_t ports[2];
+
+static const uint16_t fill = SSP_FILL;  // DMA source without a tx buffer
+static uint16_t discard;                // DMA sink without an rx buffer
+
+/* ==================== Helper Functions ==================== */
+
+static LPC_SSP_TypeDef *get_ssp_base(ssp_num_t ssp) {
+    return (ssp == SSP_1) ? LPC_SSP1 : LPC_SSP0;
+}
+
+static clock_periph_t get_ssp_pclk(ssp_num_t ssp) {
+    return (ssp == SSP_1) ? CLOCK_PCLK_SSP1 : CLOCK_PCLK_SSP0;
+}
+
+// Frames nobody reads would overrun the RX FIFO
+static void drain_rx(LPC_SSP_TypeDef *regs) {
+    while(regs->SR & SR_RNE) {
+        (void)regs->DR;
+    }
+}
+
+static void ssp_clock_changed(uint32_t cpu_hz) {
+    (void)cpu_hz;
+    for(uint8_t ssp = 0; ssp < 2; ssp++) {
+        if(ports[ssp].hz) {
+            ssp_set_rate((ssp_num_t)ssp, ports[ssp].hz);
+        }
+    }
+}
+
+static void xfer_start(ssp_num_t ssp);
+
+// Pop the finished head, start the next one, then tell the owner: the
+// callback can resubmit without racing the queue
+static void xfer_finish(ssp_num_t ssp) {
+    ssp_port_t *port = &ports[ssp];
+    ssp_xfer_t *done = port->head;
+
+    get_ssp_base(ssp)->DMACR = 0;
+    port->head = done->next;
+    if(!port->head) {
+        port->tail = 0;
+    }
+    done->queued = false;
+
+    if(port->head) {
+        xfer_start(ssp);
+    }
+    if(done->callback) {
+        done->callback(done);
+    }
+}
+
+/* ==================== FIFO Engine ==================== */
+
+// Keep at most SSP_FIFO_DEPTH frames in flight, so RX can never overrun
+static void fifo_fill(ssp_num_t ssp) {
+    ssp_port_t *port = &ports[ssp];
+    const ssp_xfer_t *x = port->head;
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+
+    while(port->tx_pos < x->count && (uint16_t)(port->tx_pos - port->rx_pos) < SSP_FIFO_DEPTH) {
+        uint16_t frame = fill;
+
+        if(x->tx) {
+            frame = port->wide ? ((const uint16_t *)x->tx)[port->tx_pos]
+                               : ((const uint8_t *)x->tx)[port->tx_pos];
+        }
+        regs->DR = frame;
+        port->tx_pos++;
+    }
+}
+
+static void fifo_drain(ssp_num_t ssp) {
+    ssp_port_t *port = &ports[ssp];
+    const ssp_xfer_t *x = port->head;
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+
+    while(regs->SR & SR_RNE) {
+        uint16_t frame = regs->DR;
+
+        if(x->rx) {
+            if(port->wide) {
+                ((uint16_t *)x->rx)[port->rx_pos] = frame;
+            } else {
+                ((uint8_t *)x->rx)[port->rx_pos] = (uint8_t)frame;
+            }
+        }
+        port->rx_pos++;
+    }
+}
+
+// Half-full for bulk frames, timeout for the last few of a transfer
+static void ssp_irq(ssp_num_t ssp) {
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+    ssp_port_t *port = &ports[ssp];
+
+    regs->ICR = ICR_RTIC;
+    if(!port->head) {
+        regs->IMSC = 0;
+        return;
+    }
+
+    fifo_drain(ssp);
+    if(port->rx_pos < port->head->count) {
+        fifo_fill(ssp);
+    } else {
+        regs->IMSC = 0;
+        xfer_finish(ssp);
+    }
+}
+
+void SSP0_IRQHandler(void) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_SSP0, DIAG_NO_LATENCY);
+    ssp_irq(SSP_0);
+    DIAG_IRQ_EXIT(DIAG_IRQ_SSP0);
+}
+
+void SSP1_IRQHandler(void) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_SSP1, DIAG_NO_LATENCY);
+    ssp_irq(SSP_1);
+    DIAG_IRQ_EXIT(DIAG_IRQ_SSP1);
+}
+
+/* ==================== DMA Engine ==================== */
+
+static void dma_chunk(ssp_num_t ssp);
+
+// RX channel done: every frame of the chunk has been clocked in
+static void dma_rx_done(uint8_t channel, bool error) {
+    ssp_num_t ssp = (ssp_num_t)(channel / 2);
+    ssp_port_t *port = &ports[ssp];
+
+    port->rx_pos += port->chunk;
+    if(!error && port->rx_pos < port->head->count) {
+        dma_chunk(ssp);
+    } else {
+        xfer_finish(ssp);
+    }
+}
+
+// Next slice of up to DMA_MAX_TRANSFER frames, RX armed before TX
+static void dma_chunk(ssp_num_t ssp) {
+    ssp_port_t *port = &ports[ssp];
+    const ssp_xfer_t *x = port->head;
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+    uint16_t n = x->count - port->rx_pos;
+    uint8_t width = port->wide ? DMA_WIDTH_16 : 0;
+    uint8_t size = port->wide ? 2 : 1;
+
+    if(n > DMA_MAX_TRANSFER) {
+        n = DMA_MAX_TRANSFER;
+    }
+    port->chunk = n;
+
+    const volatile void *src = x->tx ? (const uint8_t *)x->tx + port->rx_pos * size : (const void *)&fill;
+    volatile void *dst = x->rx ? (uint8_t *)x->rx + port->rx_pos * size : (void *)&discard;
+
+    regs->DMACR = DMACR_RXDMAE | DMACR_TXDMAE;
+    dma_start_ex(SSP_DMA_RX_CHANNEL(ssp), DMA_P2M,
+                 (ssp == SSP_1) ? DMA_REQ_SSP1_RX : DMA_REQ_SSP0_RX,
+                 &regs->DR, dst, n, width | (x->rx ? 0 : DMA_NO_INC), dma_rx_done);
+    dma_start_ex(SSP_DMA_TX_CHANNEL(ssp), DMA_M2P,
+                 (ssp == SSP_1) ? DMA_REQ_SSP1_TX : DMA_REQ_SSP0_TX,
+                 src, &regs->DR, n, width | (x->tx ? 0 : DMA_NO_INC), 0);
+}
+
+// Head of the queue onto the wire (interrupts off or from an SSP/DMA ISR)
+static void xfer_start(ssp_num_t ssp) {
+    ssp_port_t *port = &ports[ssp];
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+
+    port->tx_pos = 0;
+    port->rx_pos = 0;
+    drain_rx(regs);
+
+    if(port->head->flags & SSP_XFER_DMA) {
+        dma_chunk(ssp);
+    } else {
+        fifo_fill(ssp);
+        regs->IMSC = IMSC_RTIM | IMSC_RXIM;
+    }
+}
+
+/* ==================== Public Functions ==================== */
+
+uint32_t ssp_init(ssp_num_t ssp, uint32_t hz, uint8_t bits, ssp_mode_t mode) {
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+
+    if(bits < 4 || bits > 16 || hz == 0) {
+        return 0;
+    }
+
+    // 1. Power, PCLK = CCLK (finest rate steps), pins
+    if(ssp == SSP_1) {
+        LPC_SC->PCONP |= (1 << 10);
+        gpio_config_table(ssp1_pins, sizeof(ssp1_pins) / sizeof(ssp1_pins[0]));
+    } else {
+        LPC_SC->PCONP |= (1 << 21);
+        gpio_config_table(ssp0_pins, sizeof(ssp0_pins) / sizeof(ssp0_pins[0]));
+    }
+    clock_set_pclk(get_ssp_pclk(ssp), 1);
+
+    // 2. SPI frame format, master, interrupts off until a transfer runs
+    regs->CR1 = 0;
+    regs->CR0 = CR0_DSS(bits)
+              | ((mode & 2) ? CR0_CPOL : 0) | ((mode & 1) ? CR0_CPHA : 0);
+    regs->IMSC = 0;
+    regs->DMACR = 0;
+    ports[ssp].head = 0;
+    ports[ssp].tail = 0;
+    ports[ssp].wide = (bits > 8);
+
+    // 3. Rate, following CPU clock changes
+    static bool clock_attached = false;
+    if(!clock_attached) {
+        clock_attach(ssp_clock_changed);
+        clock_attached = true;
+    }
+    uint32_t actual = ssp_set_rate(ssp, hz);
+
+    // 4. Enable
+    regs->CR1 = CR1_SSE;
+    drain_rx(regs);
+    dma_init();
+    NVIC_EnableIRQ((ssp == SSP_1) ? SSP1_IRQn : SSP0_IRQn);
+
+    return actual;
+}
+
+uint32_t ssp_set_rate(ssp_num_t ssp, uint32_t hz) {
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+    uint32_t pclk = clock_get_pclk(get_ssp_pclk(ssp));
+    uint32_t cpsr, div = 0;
+
+    if(hz == 0) {
+        return 0;
+    }
+    for(cpsr = 2; cpsr <= CPSR_MAX; cpsr += 2) {
+        div = (pclk + cpsr * hz - 1) / (cpsr * hz);  // SCR + 1, rounded up
+        if(div <= SCR_MAX + 1) {
+            break;
+        }
+    }
+    if(cpsr > CPSR_MAX) {
+        return 0;
+    }
+    if(div == 0) {
+        div = 1;  // hz above PCLK / 2
+    }
+
+    ports[ssp].hz = hz;
+    regs->CPSR = cpsr;
+    regs->CR0 = (regs->CR0 & ~CR0_SCR_MASK) | CR0_SCR(div - 1);
+
+    return pclk / (cpsr * div);
+}
+
+bool ssp_submit(ssp_num_t ssp, ssp_xfer_t *xfer) {
+    ssp_port_t *port = &ports[ssp];
+    uint32_t primask;
+
+    if(xfer->queued || xfer->count == 0) {
+        return false;
+    }
+    xfer->next = 0;
+    xfer->queued = true;
+
+    // The queue is shared with the SSP and DMA interrupts. Callers may
+    // hold their own critical section (display_max7219.c), keep it.
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if(port->tail) {
+        port->tail->next = xfer;
+        port->tail = xfer;
+    } else {
+        port->head = port->tail = xfer;
+        xfer_start(ssp);
+    }
+    __set_PRIMASK(primask);
+    return true;
+}
+
+void ssp_write(ssp_num_t ssp, const void *frames, size_t count) {
+    LPC_SSP_TypeDef *regs = get_ssp_base(ssp);
+
+    for(size_t i = 0; i < count; i++) {
+        while(!(regs->SR & SR_TNF)) {
+            drain_rx(regs);
+        }
+        regs->DR = ports[ssp].wide ? ((const uint16_t *)frames)[i]
+                                   : ((const uint8_t *)frames)[i];
+    }
+    drain_rx(regs);
+}
+
+bool ssp_busy(ssp_num_t ssp) {
+    return ports[ssp].head || (get_ssp_base(ssp)->SR & SR_BSY);
+}
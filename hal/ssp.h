@@ -0,0 +1,127 @@
+/**
+ * @file ssp.h
+ * @brief SSP (SPI master) HAL for LPC1768
+ * @note Full-duplex transfers are described by caller-owned ssp_xfer_t
+ *       records and queued per port. Each runs either from the SSP
+ *       interrupt, topping up the 8-frame FIFO, or by GPDMA with no CPU
+ *       work until it completes. Frames of up to 8 bits are stored one per
+ *       byte, wider frames one per halfword.
+ */
+
+#ifndef SSP_H
+#define SSP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ==================== Configuration ==================== */
+// Frame sent when a transfer has no tx buffer (e.g. reading from flash)
+#ifndef SSP_FILL
+#define SSP_FILL            0xFFFF
+#endif
+
+/* ==================== SSP Selection ==================== */
+typedef enum {
+    SSP_0 = 0,  // P0.15 SCK, P0.16 SSEL, P0.17 MISO, P0.18 MOSI
+    SSP_1 = 1   // P0.7 SCK, P0.6 SSEL, P0.8 MISO, P0.9 MOSI
+} ssp_num_t;
+
+/* ==================== SPI Mode ==================== */
+// CPOL (idle clock level) in bit 1, CPHA (sample on second edge) in bit 0.
+// With CPHA = 0 SSEL goes high between frames, with CPHA = 1 it stays low
+// until the FIFO runs empty.
+typedef enum {
+    SSP_MODE_0 = 0,  // Idle low, sample on rising edge
+    SSP_MODE_1 = 1,  // Idle low, sample on falling edge
+    SSP_MODE_2 = 2,  // Idle high, sample on falling edge
+    SSP_MODE_3 = 3   // Idle high, sample on rising edge
+} ssp_mode_t;
+
+#define SSP_FIFO_DEPTH      8
+
+// GPDMA channels for SSP_XFER_DMA (UART DMA uses channels 4-7). RX has the
+// lower number, so it wins arbitration and the RX FIFO never overruns.
+#define SSP_DMA_RX_CHANNEL(ssp)  ((ssp) * 2)
+#define SSP_DMA_TX_CHANNEL(ssp)  ((ssp) * 2 + 1)
+
+/* ==================== Transfer Descriptor ==================== */
+#define SSP_XFER_DMA        0x01  // Stream by GPDMA instead of the SSP interrupt
+
+typedef struct ssp_xfer ssp_xfer_t;
+
+// Called from interrupt context when a transfer has finished
+typedef void (*ssp_callback_t)(ssp_xfer_t *xfer);
+
+struct ssp_xfer {
+    const void *tx;              // Frames to send, NULL sends SSP_FILL
+    void *rx;                    // Received frames, NULL discards them
+    uint16_t count;              // Number of frames
+    uint8_t flags;               // SSP_XFER_DMA
+    ssp_callback_t callback;     // May be NULL
+    void *arg;                   // For the callback
+    struct ssp_xfer *next;       // Queue link (driver only)
+    volatile bool queued;        // Submitted and not finished (driver only)
+};
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Power on an SSP port as SPI master and route its pins
+ * @param ssp SSP port
+ * @param hz Bit rate, see ssp_set_rate()
+ * @param bits Frame size 4-16
+ * @param mode SPI mode
+ * @return Actual bit rate in Hz, 0 if hz or bits is out of range
+ * @example ssp_init(SSP_0, 1000000, 8, SSP_MODE_3);
+ */
+uint32_t ssp_init(ssp_num_t ssp, uint32_t hz, uint8_t bits, ssp_mode_t mode);
+
+/**
+ * @brief Set the bit rate from the current PCLK
+ * @param ssp SSP port
+ * @param hz Requested rate, rounded down to the nearest available one
+ * @return Actual rate in Hz, 0 if hz is below PCLK / 65024
+ * @note Rate = PCLK / (CPSR * (SCR + 1)): the smallest even prescaler
+ *       whose SCR range reaches hz, which gives the finest steps.
+ *       Re-applied automatically when clock_set_cpu() changes the CPU clock.
+ */
+uint32_t ssp_set_rate(ssp_num_t ssp, uint32_t hz);
+
+/**
+ * @brief Queue a transfer (non-blocking)
+ * @param ssp SSP port
+ * @param xfer Descriptor, buffers must stay valid until the callback
+ * @return false if xfer is already queued or count is 0
+ * @note Transfers on a port run in submission order. A callback may
+ *       submit the next transfer, including its own descriptor.
+ * @example ssp_submit(SSP_1, &read_page);
+ */
+bool ssp_submit(ssp_num_t ssp, ssp_xfer_t *xfer);
+
+/**
+ * @brief Check if a descriptor is still queued or running
+ * @param xfer Descriptor
+ */
+static inline bool ssp_pending(const ssp_xfer_t *xfer) {
+    return xfer->queued;
+}
+
+/**
+ * @brief Send frames straight into the TX FIFO
+ * @param ssp SSP port
+ * @param frames Frames, one per byte (bits <= 8) or halfword
+ * @param count Number of frames
+ * @note Waits only while the FIFO is full, so a burst of up to
+ *       SSP_FIFO_DEPTH frames returns at once. Received frames are
+ *       discarded. Only while no ssp_submit() transfer is queued.
+ */
+void ssp_write(ssp_num_t ssp, const void *frames, size_t count);
+
+/**
+ * @brief Check if transfers are queued or frames are still shifting out
+ * @param ssp SSP port
+ */
+bool ssp_busy(ssp_num_t ssp);
+
+#endif // SSP_H
@@ -0,0 +1,216 @@
+/**
+ * @file store.c
+ * @brief Wear-levelled record store implementation
+ */
+
+#include "store.h"
+#include "frame.h"
+#include "swtimer.h"
+
+/* ==================== Page Layout ==================== */
+#define SEQ_ERASED      0xFFFFFFFFUL
+
+typedef struct {
+    uint32_t seq;                   // Commit number, SEQ_ERASED if unused
+    uint16_t len;                   // Bytes of data in use
+    uint16_t crc;                   // CRC-16 of seq, len and data[0..len)
+    uint8_t data[STORE_DATA_MAX];
+} store_page_t;                     // Exactly one IAP page
+
+/* ==================== Driver State ==================== */
+static const uint8_t sectors[2] = { STORE_SECTOR_A, STORE_SECTOR_B };
+static uint8_t active = 0;          // Index into sectors[] of the log head
+static uint16_t next_page = 0;      // First unused page of the active sector
+static uint32_t last_seq = 0;
+
+static uint8_t shadow[STORE_DATA_MAX];  // Latest record, stored or pending
+static uint16_t shadow_len = 0;
+static bool dirty = false;
+static swtimer_t commit_timer;
+static store_busy_t busy_hook = 0;
+static store_page_t page_buf;       // Word aligned RAM source for IAP
+
+/* ==================== Helper Functions ==================== */
+
+static uint16_t pages_per_sector(uint8_t index) {
+    return iap_sector_size(sectors[index]) / IAP_PAGE_SIZE;
+}
+
+static const store_page_t *page_at(uint8_t index, uint16_t page) {
+    return (const store_page_t *)(uintptr_t)(iap_sector_addr(sectors[index]) + (uint32_t)page * IAP_PAGE_SIZE);
+}
+
+static uint16_t page_crc(const store_page_t *p) {
+    uint16_t crc = frame_crc16(FRAME_CRC_INIT, (const uint8_t *)p, 6);  // seq, len
+    return frame_crc16(crc, p->data, p->len);
+}
+
+// Fully erased, a torn write may have programmed any part of a page
+static bool page_blank(const store_page_t *p) {
+    const uint32_t *word = (const uint32_t *)p;
+
+    for(uint16_t i = 0; i < IAP_PAGE_SIZE / 4; i++) {
+        if(word[i] != 0xFFFFFFFFUL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool page_valid(const store_page_t *p) {
+    return p->seq != SEQ_ERASED && p->len <= STORE_DATA_MAX && p->crc == page_crc(p);
+}
+
+// Pages are used in order: binary search for the first blank one
+static uint16_t log_end(uint8_t index) {
+    uint16_t lo = 0, hi = pages_per_sector(index);
+
+    while(lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if(page_blank(page_at(index, mid))) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+// Newest intact record before end, skipping torn writes
+static const store_page_t *log_latest(uint8_t index, uint16_t end) {
+    while(end--) {
+        const store_page_t *p = page_at(index, end);
+        if(page_valid(p)) {
+            return p;
+        }
+    }
+    return 0;
+}
+
+// Flash programming with the busy hook around it
+static bool commit_page(void) {
+    bool ok = false;
+
+    if(busy_hook) {
+        busy_hook(true);
+    }
+    for(uint16_t tries = 0; tries < 2 * pages_per_sector(active) && !ok; tries++) {
+        if(next_page >= pages_per_sector(active)) {
+            uint8_t other = active ^ 1;
+            if(iap_blank_check(sectors[other]) != IAP_OK && iap_erase(sectors[other]) != IAP_OK) {
+                break;
+            }
+            active = other;
+            next_page = 0;
+        }
+
+        const store_page_t *dst = page_at(active, next_page++);
+        if(!page_blank(dst)) {
+            continue;  // Torn by a reset during a write
+        }
+        ok = (iap_program((uint32_t)(uintptr_t)dst, &page_buf, IAP_PAGE_SIZE) == IAP_OK);
+    }
+    if(busy_hook) {
+        busy_hook(false);
+    }
+    return ok;
+}
+
+static void commit_expired(void *arg) {
+    (void)arg;
+    store_flush();
+}
+
+/* ==================== Public Functions ==================== */
+
+bool store_init(void) {
+    uint16_t end[2];
+    const store_page_t *latest[2];
+
+    swtimer_setup(&commit_timer, commit_expired, 0, SWTIMER_DEFERRED);
+
+    for(uint8_t i = 0; i < 2; i++) {
+        end[i] = log_end(i);
+        latest[i] = log_latest(i, end[i]);
+    }
+
+    // The log head is the sector holding the highest sequence number
+    active = (latest[1] && (!latest[0] || latest[1]->seq > latest[0]->seq)) ? 1 : 0;
+    next_page = end[active];
+
+    const store_page_t *p = latest[active];
+    if(!p) {
+        return false;
+    }
+    last_seq = p->seq;
+    shadow_len = p->len;
+    for(uint16_t i = 0; i < p->len; i++) {
+        shadow[i] = p->data[i];
+    }
+    return true;
+}
+
+size_t store_load(void *buf, size_t max) {
+    uint8_t *out = (uint8_t *)buf;
+    size_t len = (shadow_len < max) ? shadow_len : max;
+
+    for(size_t i = 0; i < len; i++) {
+        out[i] = shadow[i];
+    }
+    return len;
+}
+
+bool store_save(const void *data, size_t len) {
+    const uint8_t *in = (const uint8_t *)data;
+    bool same = (len == shadow_len);
+
+    if(len > STORE_DATA_MAX) {
+        return false;
+    }
+    for(size_t i = 0; i < len && same; i++) {
+        same = (shadow[i] == in[i]);
+    }
+    if(same) {
+        return true;  // Nothing new (stored or already pending)
+    }
+
+    for(size_t i = 0; i < len; i++) {
+        shadow[i] = in[i];
+    }
+    shadow_len = (uint16_t)len;
+
+    // Armed by the first change only, so a steady stream still commits
+    if(!dirty) {
+        dirty = true;
+        swtimer_start(&commit_timer, STORE_COMMIT_MS, 0);
+    }
+    return true;
+}
+
+bool store_flush(void) {
+    if(!dirty) {
+        return true;
+    }
+    swtimer_stop(&commit_timer);
+
+    // 1. Build the page, unused bytes stay erased
+    page_buf.seq = last_seq + 1;
+    page_buf.len = shadow_len;
+    for(uint16_t i = 0; i < STORE_DATA_MAX; i++) {
+        page_buf.data[i] = (i < shadow_len) ? shadow[i] : 0xFF;
+    }
+    page_buf.crc = page_crc(&page_buf);
+
+    // 2. Append, wrapping onto the other sector (erasing it) when full
+    if(commit_page()) {
+        last_seq = page_buf.seq;
+        dirty = false;
+        return true;
+    }
+    swtimer_start(&commit_timer, STORE_COMMIT_MS, 0);  // Retry later
+    return false;
+}
+
+void store_attach(store_busy_t busy) {
+    busy_hook = busy;
+}
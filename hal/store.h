@@ -0,0 +1,87 @@
+/**
+ * @file store.h
+ * @brief Wear-levelled record store in the top flash sectors
+ * @note Log-structured: every commit writes the whole record to the next
+ *       free 256-byte page, alternating between two sectors. A sector is
+ *       erased only when the log wraps onto it, so each erase is spread
+ *       over a sector's worth of commits. Saves are batched in RAM and
+ *       committed from the main loop, never from an ISR.
+ */
+
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "iap.h"
+
+/* ==================== Configuration ==================== */
+// The two 32 KB sectors holding the log (keep them out of the image)
+#ifndef STORE_SECTOR_A
+#define STORE_SECTOR_A      28    // 0x00070000
+#endif
+
+#ifndef STORE_SECTOR_B
+#define STORE_SECTOR_B      29    // 0x00078000
+#endif
+
+// Delay from the first unsaved change to the flash write. Changes within
+// the window are written together: at most one page per interval.
+#ifndef STORE_COMMIT_MS
+#define STORE_COMMIT_MS     10000
+#endif
+
+// Record data per page (page header is 8 bytes)
+#define STORE_DATA_MAX      (IAP_PAGE_SIZE - 8)
+
+// Called with true before the flash is written or erased, false after
+typedef void (*store_busy_t)(bool busy);
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Find the latest record
+ * @return true if one was found (store_load() returns it)
+ * @note Binary search for the end of each log: O(log pages) flash reads,
+ *       independent of the number of writes so far
+ */
+bool store_init(void);
+
+/**
+ * @brief Copy the latest record (stored or pending)
+ * @param buf Destination
+ * @param max Size of buf
+ * @return Record length, 0 if there is none
+ */
+size_t store_load(void *buf, size_t max);
+
+/**
+ * @brief Replace the record, written after STORE_COMMIT_MS
+ * @param data Record bytes
+ * @param len Length, at most STORE_DATA_MAX
+ * @return false if len is too large
+ * @note Cheap enough for every change: unchanged data is ignored and
+ *       the commit timer is not pushed back by later saves
+ * @example store_save(&config, sizeof(config));
+ */
+bool store_save(const void *data, size_t len);
+
+/**
+ * @brief Write a pending record now (main loop only)
+ * @return false on a flash error (the record stays pending)
+ * @note Interrupts are off for ~1 ms, or ~100 ms when a sector is erased
+ *       (once per 128 commits), see iap.h for the cost
+ */
+bool store_flush(void);
+
+/**
+ * @brief Register a function bracketing every flash write and erase
+ * @param busy Callback (main loop context), 0 to remove it
+ * @note For hardware that misbehaves with its interrupts on hold, e.g.
+ *       a multiplexed display that would keep one digit lit
+ * @example store_attach(flash_busy);  // Blanks the display meanwhile
+ */
+void store_attach(store_busy_t busy);
+
+#endif // STORE_H
@@ -0,0 +1,308 @@
+/**
+ * @file swtimer.c
+ * @brief Hashed timer wheel implementation
+ */
+
+#include "swtimer.h"
+#include "systick.h"
+#include "ringbuf.h"
+#include <lpc17xx.h>
+
+/* ==================== Definitions ==================== */
+#define WHEEL_MASK          (SWTIMER_WHEEL_SIZE - 1)
+#define SYSTICK_EXCEPTION   15   // IPSR value inside SysTick_Handler
+
+// A timer is "due" when its expiry is not in the future (wrap-safe)
+#define IS_DUE(expires, now)  ((int32_t)((expires) - (now)) <= 0)
+
+typedef enum {
+    CMD_START = 0,
+    CMD_STOP  = 1
+} swtimer_op_t;
+
+typedef struct {
+    swtimer_t *timer;
+    uint16_t op;
+    uint8_t seq;     // timer->seq of the request
+    uint32_t when;   // millis() at the request, so queuing adds no delay
+} swtimer_cmd_t;
+
+// An expired deferred timer, stale once the timer is restarted or stopped
+typedef struct {
+    swtimer_t *timer;
+    uint8_t seq;     // wheel_seq at expiry
+} swtimer_fired_t;
+
+// Occupied-slot bitmap, one bit per wheel slot
+#define OCC_BITS   (SWTIMER_WHEEL_SIZE < 32 ? SWTIMER_WHEEL_SIZE : 32)
+#define OCC_WORDS  (SWTIMER_WHEEL_SIZE / OCC_BITS)
+
+/* ==================== Wheel State ==================== */
+// The wheel is only modified in SysTick context. The main loop hands its
+// requests over through cmd_ring, expired deferred timers come back
+// through fired_ring, so no interrupts are ever disabled.
+static swtimer_t *wheel[SWTIMER_WHEEL_SIZE];
+static uint32_t occupied[OCC_WORDS];          // Slots with a timer in them
+static uint32_t last_run = 0;                 // Last millis() processed
+static volatile uint32_t next_expiry = 0;     // No expiry in the wheel is earlier
+static volatile bool have_next = false;
+
+static swtimer_cmd_t cmd_storage[SWTIMER_CMD_QUEUE];
+static ringbuf_t cmd_ring;
+static swtimer_fired_t fired_storage[SWTIMER_FIRED_QUEUE];
+static ringbuf_t fired_ring;
+
+/* ==================== Helper Functions ==================== */
+
+static bool in_tick_context(void) {
+    return (__get_IPSR() & 0x1FF) == SYSTICK_EXCEPTION;
+}
+
+static void wheel_link(swtimer_t *t) {
+    uint32_t i = t->expires & WHEEL_MASK;
+    swtimer_t **slot = &wheel[i];
+
+    t->prev = 0;
+    t->next = *slot;
+    if (*slot) {
+        (*slot)->prev = t;
+    }
+    *slot = t;
+    t->linked = 1;
+    occupied[i / OCC_BITS] |= 1UL << (i % OCC_BITS);
+
+    if (!have_next || (int32_t)(t->expires - next_expiry) < 0) {
+        next_expiry = t->expires;
+        have_next = true;
+    }
+}
+
+static void wheel_unlink(swtimer_t *t) {
+    uint32_t i = t->expires & WHEEL_MASK;
+
+    if (t->prev) {
+        t->prev->next = t->next;
+    } else {
+        wheel[i] = t->next;
+    }
+    if (t->next) {
+        t->next->prev = t->prev;
+    }
+    t->linked = 0;
+    if (!wheel[i]) {
+        occupied[i / OCC_BITS] &= ~(1UL << (i % OCC_BITS));
+    }
+}
+
+// Slots from now to the next occupied one (1..SWTIMER_WHEEL_SIZE), 0 if none
+static uint32_t next_occupied(uint32_t now) {
+    uint32_t d = 1;
+
+    while (d <= SWTIMER_WHEEL_SIZE) {
+        uint32_t i = (now + d) & WHEEL_MASK;
+        uint32_t bits = occupied[i / OCC_BITS] >> (i % OCC_BITS);
+
+        if (bits) {
+            return d + __CLZ(__RBIT(bits));  // Lowest set bit
+        }
+        d += OCC_BITS - (i % OCC_BITS);      // Rest of this word is empty
+    }
+    return 0;
+}
+
+// After a tick: the next occupied slot. A timer more than a wheel turn
+// out makes this early, the tick then finds nothing due and moves on, so
+// it costs one wake-up per turn in tickless idle instead of a full scan.
+static void update_next_expiry(uint32_t now) {
+    uint32_t d = next_occupied(now);
+
+    next_expiry = now + d;
+    have_next = (d != 0);
+}
+
+static void apply_start(swtimer_t *t, uint32_t when, uint32_t now, uint8_t seq) {
+    if (t->linked) {
+        wheel_unlink(t);
+    }
+    t->wheel_seq = seq;
+    t->expires = when + (t->delay ? t->delay : 1);
+    if (IS_DUE(t->expires, now)) {
+        t->expires = now;  // Already due: fire on this tick
+    }
+    wheel_link(t);
+}
+
+static void apply_stop(swtimer_t *t) {
+    if (t->linked) {
+        wheel_unlink(t);
+    }
+}
+
+// Unlink every due timer of one slot onto the expired list
+static swtimer_t *collect_due(uint32_t slot, uint32_t now, swtimer_t *expired) {
+    swtimer_t *t = wheel[slot];
+
+    while (t) {
+        swtimer_t *next = t->next;
+        if (IS_DUE(t->expires, now)) {
+            wheel_unlink(t);
+            t->fire_next = expired;
+            expired = t;
+        }
+        t = next;
+    }
+    return expired;
+}
+
+/* ==================== Public Functions ==================== */
+
+void swtimer_init(void) {
+    for (uint32_t i = 0; i < SWTIMER_WHEEL_SIZE; i++) {
+        wheel[i] = 0;
+    }
+    for (uint32_t i = 0; i < OCC_WORDS; i++) {
+        occupied[i] = 0;
+    }
+    ringbuf_init(&cmd_ring, cmd_storage, sizeof(swtimer_cmd_t), SWTIMER_CMD_QUEUE);
+    ringbuf_init(&fired_ring, fired_storage, sizeof(swtimer_fired_t), SWTIMER_FIRED_QUEUE);
+    have_next = false;
+    last_run = millis();
+
+    systick_attach(swtimer_tick);
+    systick_add_deadline(swtimer_next_deadline);
+}
+
+void swtimer_setup(swtimer_t *timer, swtimer_callback_t callback, void *arg, uint8_t flags) {
+    timer->next = 0;
+    timer->prev = 0;
+    timer->fire_next = 0;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->flags = flags;
+    timer->linked = 0;
+    timer->wheel_seq = 0;
+    timer->seq = 0;
+    timer->armed = 0;
+}
+
+bool swtimer_start(swtimer_t *timer, uint32_t delay_ms, uint32_t period_ms) {
+    uint8_t seq = timer->seq + 1;  // Expiries already queued go stale
+
+    timer->delay = delay_ms;
+    timer->period = period_ms;
+    timer->seq = seq;
+    timer->armed = 1;
+
+    uint32_t now = millis();
+    if (in_tick_context()) {
+        apply_start(timer, now, now + 1, seq);  // Never due before the next tick
+        return true;
+    }
+
+    swtimer_cmd_t cmd = { timer, CMD_START, seq, now };
+    return ringbuf_put(&cmd_ring, &cmd);
+}
+
+bool swtimer_stop(swtimer_t *timer) {
+    timer->armed = 0;  // Blocks any pending or in-flight callback
+    timer->seq++;
+
+    if (in_tick_context()) {
+        apply_stop(timer);
+        return true;
+    }
+
+    swtimer_cmd_t cmd = { timer, CMD_STOP, 0, 0 };
+    return ringbuf_put(&cmd_ring, &cmd);
+}
+
+bool swtimer_active(const swtimer_t *timer) {
+    return timer->armed != 0;
+}
+
+void swtimer_tick(void) {
+    uint32_t now = millis();
+    swtimer_cmd_t cmd;
+
+    // 1. Apply requests from the main loop
+    while (ringbuf_get(&cmd_ring, &cmd)) {
+        if (cmd.op == CMD_START) {
+            apply_start(cmd.timer, cmd.when, now, cmd.seq);
+        } else {
+            apply_stop(cmd.timer);
+        }
+    }
+
+    // 2. Collect due timers from every slot passed since the last run
+    //    (more than one after tickless idle), all slots if we lapped the wheel
+    uint32_t span = now - last_run;
+    if (span > SWTIMER_WHEEL_SIZE) {
+        span = SWTIMER_WHEEL_SIZE;
+    }
+    last_run = now;
+
+    if (!have_next || !IS_DUE(next_expiry, now)) {
+        return;  // Nothing can be due yet
+    }
+
+    swtimer_t *expired = 0;
+    for (uint32_t i = 0; i < span; i++) {
+        expired = collect_due((now - i) & WHEEL_MASK, now, expired);
+    }
+
+    // 3. Re-arm periodic timers first so callbacks may stop them, then fire
+    while (expired) {
+        swtimer_t *t = expired;
+        expired = t->fire_next;
+
+        if (!t->armed || t->linked) {
+            continue;  // Stopped, or restarted by an earlier callback
+        }
+
+        if (t->period) {
+            do {
+                t->expires += t->period;  // Drift-free, skips missed periods
+            } while (IS_DUE(t->expires, now));
+            wheel_link(t);
+        } else if (!(t->flags & SWTIMER_DEFERRED)) {
+            t->armed = 0;  // Deferred one-shots are disarmed by swtimer_run()
+        }
+
+        if (t->flags & SWTIMER_DEFERRED) {
+            swtimer_fired_t f = { t, t->wheel_seq };
+            ringbuf_put(&fired_ring, &f);  // Dropped if main is far behind
+        } else {
+            t->callback(t->arg);
+        }
+    }
+
+    update_next_expiry(now);
+}
+
+void swtimer_run(void) {
+    swtimer_fired_t f;
+
+    while (ringbuf_get(&fired_ring, &f)) {
+        swtimer_t *t = f.timer;
+
+        if (!t->armed || f.seq != t->seq) {
+            continue;  // Stopped or restarted after it expired
+        }
+        if (!t->period) {
+            t->armed = 0;
+        }
+        t->callback(t->arg);
+    }
+}
+
+uint32_t swtimer_next_deadline(void) {
+    if (!ringbuf_empty(&cmd_ring) || !ringbuf_empty(&fired_ring)) {
+        return 0;  // Requests or callbacks waiting, keep ticking
+    }
+    if (!have_next) {
+        return SYSTICK_NO_DEADLINE;
+    }
+
+    int32_t remaining = (int32_t)(next_expiry - millis());
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
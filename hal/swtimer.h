@@ -0,0 +1,109 @@
+/**
+ * @file swtimer.h
+ * @brief Software timers on a hashed timer wheel driven by SysTick
+ * @note O(1) start/stop. Callbacks run in SysTick context, or in the main
+ *       loop from swtimer_run() when SWTIMER_DEFERRED is set.
+ */
+
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ==================== Configuration ==================== */
+// Wheel slots (power of 2), one slot per millisecond
+#ifndef SWTIMER_WHEEL_SIZE
+#define SWTIMER_WHEEL_SIZE   64
+#endif
+
+// Pending start/stop requests from the main loop (power of 2)
+#ifndef SWTIMER_CMD_QUEUE
+#define SWTIMER_CMD_QUEUE    8
+#endif
+
+// Expired SWTIMER_DEFERRED timers waiting for swtimer_run() (power of 2)
+#ifndef SWTIMER_FIRED_QUEUE
+#define SWTIMER_FIRED_QUEUE  8
+#endif
+
+/* ==================== Flags ==================== */
+#define SWTIMER_ISR        0x00  // Run callback in SysTick context
+#define SWTIMER_DEFERRED   0x01  // Run callback from swtimer_run() in main
+
+/* ==================== Types ==================== */
+typedef void (*swtimer_callback_t)(void *arg);
+
+typedef struct swtimer {
+    struct swtimer *next;          // Wheel slot list (SysTick context only)
+    struct swtimer *prev;
+    struct swtimer *fire_next;     // Expired list during one tick
+    uint32_t expires;              // millis() value at next expiry
+    uint32_t delay;                // First expiry, ms after start
+    uint32_t period;               // Reload interval in ms, 0 = one-shot
+    swtimer_callback_t callback;
+    void *arg;
+    uint8_t flags;                 // SWTIMER_ISR or SWTIMER_DEFERRED
+    uint8_t linked;                // In the wheel (SysTick context only)
+    uint8_t wheel_seq;             // seq of the start the wheel entry is for
+    volatile uint8_t seq;          // Bumped by every start and stop
+    volatile uint8_t armed;        // Started and not stopped
+} swtimer_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Initialize the timer wheel and attach it to SysTick
+ * @note Call after systick_init()
+ */
+void swtimer_init(void);
+
+/**
+ * @brief Set up a timer (does not start it)
+ * @param timer Timer (static storage, must outlive its use)
+ * @param callback Function called on expiry
+ * @param arg Passed to callback
+ * @param flags SWTIMER_ISR or SWTIMER_DEFERRED
+ */
+void swtimer_setup(swtimer_t *timer, swtimer_callback_t callback, void *arg, uint8_t flags);
+
+/**
+ * @brief Start (or restart) a timer
+ * @param timer Timer set up with swtimer_setup()
+ * @param delay_ms Time until first expiry (0 = next tick)
+ * @param period_ms Reload interval, 0 for one-shot
+ * @return false if the request queue is full
+ * @note Call from main or from a SWTIMER_ISR callback only
+ * @example swtimer_start(&blink, 500, 500);  // Every 500ms
+ */
+bool swtimer_start(swtimer_t *timer, uint32_t delay_ms, uint32_t period_ms);
+
+/**
+ * @brief Stop a timer, its callback will not run after this returns
+ * @param timer Timer
+ * @return false if the request queue is full
+ * @note Call from main or from a SWTIMER_ISR callback only
+ */
+bool swtimer_stop(swtimer_t *timer);
+
+/**
+ * @brief Check if a timer is started
+ */
+bool swtimer_active(const swtimer_t *timer);
+
+/**
+ * @brief Run callbacks of expired SWTIMER_DEFERRED timers (main loop only)
+ */
+void swtimer_run(void);
+
+/**
+ * @brief Wheel tick, attached to SysTick by swtimer_init()
+ */
+void swtimer_tick(void);
+
+/**
+ * @brief Milliseconds until the next expiry (systick_idle provider)
+ */
+uint32_t swtimer_next_deadline(void);
+
+#endif // SWTIMER_H
@@ -4,10 +4,15 @@
  */
 
 #include "systick.h"
+#include "clock.h"
+#include "diag.h"
+#include <lpc17xx.h>
 
 /* ==================== SysTick Register Definitions ==================== */
 // SysTick registers (ARM Cortex-M3 core peripheral)
+#ifndef SYSTICK_BASE
 #define SYSTICK_BASE      0xE000E010
+#endif
 
 typedef struct {
     volatile uint32_t CTRL;   // Control and Status Register
@@ -24,24 +29,75 @@ typedef struct {
 #define SYSTICK_CTRL_CLKSOURCE  (1 << 2)  // Clock source (1=CPU, 0=external)
 #define SYSTICK_CTRL_COUNTFLAG  (1 << 16) // Count flag
 
+// Interrupt Control and State Register (SysTick pending bit)
+#ifndef SCB_ICSR
+#define SCB_ICSR                (*(volatile uint32_t *)0xE000ED04)
+#endif
+#define SCB_ICSR_PENDSTSET      (1UL << 26)
+#define SCB_ICSR_PENDSTCLR      (1UL << 25)
+
+// System Control Register (sleep mode selection)
+#ifndef SCB_SCR
+#define SCB_SCR                 (*(volatile uint32_t *)0xE000ED10)
+#endif
+#define SCB_SCR_SLEEPDEEP       (1UL << 2)
+
+#define SYSTICK_MAX_RELOAD      0x00FFFFFFUL
+#define SYSTICK_IDLE_MARGIN     64    // Min ticks to a boundary for cutting a sleep short
+#define SYSTICK_RUN             (SYSTICK_CTRL_ENABLE | SYSTICK_CTRL_TICKINT | SYSTICK_CTRL_CLKSOURCE)
+
+/* ==================== DWT Register Definitions ==================== */
+// Debug Exception and Monitor Control (TRCENA gates DWT)
+#ifndef DEMCR
+#define DEMCR                   (*(volatile uint32_t *)0xE000EDFC)
+#endif
+#define DEMCR_TRCENA            (1UL << 24)
+#ifndef DWT_CTRL
+#define DWT_CTRL                (*(volatile uint32_t *)0xE0001000)
+#endif
+#define DWT_CTRL_CYCCNTENA      (1UL << 0)
+
 static volatile uint32_t systick_counter = 0;  // Millisecond counter
-static uint32_t us_per_tick = 0;               // Microseconds per SysTick tick
+static uint32_t ticks_per_us = 1;              // SysTick ticks (CPU cycles) per microsecond
+static uint32_t us_per_tick_q32 = 0;           // 1000 / (reload + 1) as 0.32 fixed point
+static systick_callback_t tick_callbacks[SYSTICK_MAX_CALLBACKS];  // 1ms hooks
+static volatile uint8_t callback_count = 0;
+static uint32_t tick_reload = 0;               // LOAD value for a 1ms tick
+static systick_deadline_t deadlines[SYSTICK_MAX_DEADLINES];
+static uint8_t deadline_count = 0;
+static int32_t idle_fixup = 0;                 // Ticks a cut sleep lands late, learned
 
 /**
  * @brief SysTick interrupt handler (called every 1ms)
  * @note This function name is defined by CMSIS and will be automatically called
  */
 void SysTick_Handler(void) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_SYSTICK, SYSTICK->LOAD - SYSTICK->VAL);  // Counts down from the reload
     systick_counter++;
+    
+    for (uint8_t i = 0; i < callback_count; i++) {
+        tick_callbacks[i]();
+    }
+    DIAG_IRQ_EXIT(DIAG_IRQ_SYSTICK);
 }
 
-void systick_init(uint32_t cpu_freq_hz) {
+/**
+ * @brief Program the 1ms tick for a CPU frequency
+ * @note Also the clock change callback: the ms counter is kept, the
+ *       partial ms in progress restarts at the new rate
+ */
+static void systick_set_clock(uint32_t cpu_freq_hz) {
     // Calculate reload value for 1ms tick
     // SysTick counts down from LOAD to 0, then reloads
     uint32_t reload_value = (cpu_freq_hz / 1000) - 1;  // 1ms tick
+    tick_reload = reload_value;
     
-    // Calculate microseconds per tick for micros() function
-    us_per_tick = 1000000 / cpu_freq_hz;
+    // Precompute scale factors so delay_us()/micros() never divide
+    ticks_per_us = cpu_freq_hz / 1000000;
+    if (ticks_per_us == 0) {
+        ticks_per_us = 1;  // Sub-MHz clocks: delay_us() rounds up
+    }
+    us_per_tick_q32 = (uint32_t)((1000ULL << 32) / (reload_value + 1));
     
     // Disable SysTick during configuration
     SYSTICK->CTRL = 0;
@@ -56,12 +112,25 @@ void systick_init(uint32_t cpu_freq_hz) {
     // - Enable counter
     // - Enable interrupt
     // - Use processor clock
-    SYSTICK->CTRL = SYSTICK_CTRL_ENABLE | 
-                    SYSTICK_CTRL_TICKINT | 
-                    SYSTICK_CTRL_CLKSOURCE;
+    SYSTICK->CTRL = SYSTICK_RUN;
+}
+
+void systick_init(void) {
+    static uint8_t clock_attached = 0;
+    
+    systick_set_clock(clock_get_cpu());
+    if (!clock_attached) {
+        clock_attach(systick_set_clock);
+        clock_attached = 1;
+    }
     
     // Reset counter
     systick_counter = 0;
+    
+    // Start the DWT cycle counter for cycles()
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
 }
 
 void delay_ms(uint32_t ms) {
@@ -70,7 +139,7 @@ void delay_ms(uint32_t ms) {
     // Wait until elapsed time >= ms
     // Handle counter overflow correctly
     while ((systick_counter - start) < ms) {
-        // Optionally: __WFI();  // Wait for interrupt (low power)
+        __WFI();  // Sleep until the next tick (or any other interrupt)
     }
 }
 
@@ -89,7 +158,7 @@ void delay_us(uint32_t us) {
     // For sub-millisecond delays, use SysTick current value
     uint32_t start = SYSTICK->VAL;
     uint32_t reload = SYSTICK->LOAD;
-    uint32_t ticks_needed = us / us_per_tick;
+    uint32_t ticks_needed = us * ticks_per_us;
     
     // SysTick counts DOWN, so we need to handle wraparound
     while (1) {
@@ -99,8 +168,8 @@ void delay_us(uint32_t us) {
         if (current <= start) {
             elapsed = start - current;
         } else {
-            // Wrapped around
-            elapsed = start + (reload - current);
+            // Wrapped around (counts start..0, then reload..current)
+            elapsed = start + (reload + 1 - current);
         }
         
         if (elapsed >= ticks_needed) {
@@ -109,6 +178,17 @@ void delay_us(uint32_t us) {
     }
 }
 
+int systick_attach(systick_callback_t callback) {
+    uint8_t n = callback_count;
+    
+    if (n >= SYSTICK_MAX_CALLBACKS) {
+        return -1;
+    }
+    tick_callbacks[n] = callback;
+    callback_count = n + 1;  // Publish only after the slot is filled
+    return 0;
+}
+
 uint32_t millis(void) {
     return systick_counter;
 }
@@ -116,19 +196,155 @@ uint32_t millis(void) {
 uint32_t micros(void) {
     uint32_t ms;
     uint32_t tick_val;
-    uint32_t reload;
     
-    // Read values (disable interrupts briefly for consistency)
-    __disable_irq();
-    ms = systick_counter;
-    tick_val = SYSTICK->VAL;
-    reload = SYSTICK->LOAD;
-    __enable_irq();
+    // Lock-free snapshot: retry if the tick ISR ran between the two reads
+    do {
+        ms = systick_counter;
+        tick_val = SYSTICK->VAL;
+    } while (ms != systick_counter);
+    
+    uint32_t reload = SYSTICK->LOAD;
+    
+    // Counter wrapped but SysTick_Handler has not run yet (called with
+    // interrupts masked or from a higher-priority ISR)
+    if ((SCB_ICSR & SCB_ICSR_PENDSTSET) && tick_val > (reload >> 1)) {
+        ms++;
+    }
     
-    // Calculate microseconds
     // SysTick counts DOWN, so elapsed = (reload - current)
     uint32_t ticks_elapsed = reload - tick_val;
-    uint32_t us_in_current_ms = (ticks_elapsed * 1000) / (reload + 1);
+    uint32_t us_in_current_ms = (uint32_t)(((uint64_t)ticks_elapsed * us_per_tick_q32) >> 32);
     
     return (ms * 1000) + us_in_current_ms;
-}
\ No newline at end of file
+}
+
+uint32_t cycles_per_us(void) {
+    return ticks_per_us;
+}
+
+void systick_catch_up(uint32_t cycles) {
+    // Counting down on the CPU clock, the section ending now with VAL
+    // ticks left to go spans (cycles + VAL) / period reloads
+    uint32_t reloads = (cycles + SYSTICK->VAL) / (tick_reload + 1);
+    
+    if (reloads > 1) {
+        systick_counter += reloads - 1;
+    }
+}
+
+int systick_add_deadline(systick_deadline_t deadline) {
+    if (deadline_count >= SYSTICK_MAX_DEADLINES) {
+        return -1;
+    }
+    deadlines[deadline_count++] = deadline;
+    return 0;
+}
+
+uint32_t systick_next_deadline(void) {
+    uint32_t next = SYSTICK_NO_DEADLINE;
+    
+    for (uint8_t i = 0; i < deadline_count; i++) {
+        uint32_t d = deadlines[i]();
+        if (d < next) {
+            next = d;
+        }
+    }
+    return next;
+}
+
+void systick_idle(void) {
+    uint32_t ticks_per_ms = tick_reload + 1;
+    uint32_t sleep_ms = systick_next_deadline();
+    uint32_t max_ms = SYSTICK_MAX_RELOAD / ticks_per_ms + 1;
+    
+    if (sleep_ms > max_ms) {
+        sleep_ms = max_ms;
+    }
+    
+    SCB_SCR &= ~SCB_SCR_SLEEPDEEP;  // Sleep mode: SysTick keeps counting
+    
+    if (sleep_ms <= 2) {
+        __WFI();  // Next tick is soon enough, keep the periodic tick
+        return;
+    }
+    
+    // Interrupts stay pending (and still wake WFI) while masked, so the
+    // reprogramming below cannot be interleaved with SysTick_Handler.
+    // The counter never stops: LOAD only applies at the next reload, and
+    // COUNTFLAG plus VAL tell which value a reload picked up.
+    __disable_irq();
+    
+    (void)SYSTICK->CTRL;  // Reading clears COUNTFLAG
+    if (SCB_ICSR & SCB_ICSR_PENDSTSET) {
+        __enable_irq();  // A tick is due now, handle it normally
+        return;
+    }
+    
+    // The current ms runs out unchanged, then one long period ends
+    // exactly on the deadline's ms boundary
+    SYSTICK->LOAD = (sleep_ms - 1) * ticks_per_ms - 1;
+    
+    __DSB();
+    __WFI();
+    
+    // Woken by the ms boundary or by another interrupt
+    uint32_t ctrl = SYSTICK->CTRL;
+    if (!(ctrl & SYSTICK_CTRL_COUNTFLAG)) {
+        SYSTICK->LOAD = tick_reload;  // Another interrupt first, cancel
+        ctrl = SYSTICK->CTRL;         // Unless the boundary beat the store
+    }
+    if (!(ctrl & SYSTICK_CTRL_COUNTFLAG) || SYSTICK->VAL <= tick_reload) {
+        // No boundary, or it reloaded a 1ms period: periodic tick as usual
+        SYSTICK->LOAD = tick_reload;
+        __enable_irq();
+        return;
+    }
+    
+    // Long period running: 1ms periods resume by themselves after it
+    SYSTICK->LOAD = tick_reload;
+    SCB_ICSR = SCB_ICSR_PENDSTCLR;  // This boundary is counted in whole_ms
+    uint32_t whole_ms = sleep_ms;   // Boundaries passed, the pending one included
+    
+    __DSB();
+    __WFI();
+    
+    // VAL before CTRL: without COUNTFLAG the value is from the long period
+    uint32_t val = SYSTICK->VAL;
+    uint32_t val_cycles = cycles();
+    if (!(SYSTICK->CTRL & SYSTICK_CTRL_COUNTFLAG)) {
+        // Woken early: boundaries sit at VAL = k * ticks_per_ms down to 0
+        uint32_t left = (val + ticks_per_ms - 1) / ticks_per_ms;
+        whole_ms = sleep_ms - left;
+        
+        if (left > 1) {
+            // Cut the period at the next boundary (or the one after if
+            // too close to reprogram in time)
+            uint32_t next = val - (left - 1) * ticks_per_ms;
+            if (next <= SYSTICK_IDLE_MARGIN) {
+                next += ticks_per_ms;
+                whole_ms++;
+            }
+            
+            // VAL = 0 reloads from LOAD on the next tick. The ticks that
+            // pass until the store lands are taken off LOAD beforehand.
+            uint32_t now = SYSTICK->VAL;
+            SYSTICK->LOAD = next - (val - now) - (uint32_t)idle_fixup;
+            SYSTICK->VAL = 0;
+            
+            // Measure where the cut landed with the same VAL/cycles() read
+            // pair as above, so their own offset cancels, and learn the
+            // fixup for the next cut. A read follows the store by more
+            // than a tick, so VAL has reloaded.
+            uint32_t cut = SYSTICK->VAL;
+            uint32_t cut_cycles = cycles();
+            idle_fixup += (int32_t)((cut_cycles + cut) - (val_cycles + next));
+            SYSTICK->LOAD = tick_reload;
+        }
+    }
+    
+    // Let SysTick_Handler add the last ms so the tick callbacks run once
+    systick_counter += whole_ms - 1;
+    SCB_ICSR = SCB_ICSR_PENDSTSET;
+    
+    __enable_irq();
+}
@@ -9,21 +9,43 @@
 
 #include <stdint.h>
 
-/* ==================== Configuration ==================== */
-// Default CPU frequency (can be overridden before calling systick_init)
-#ifndef SYSTEM_CLOCK_HZ
-#define SYSTEM_CLOCK_HZ  100000000UL  // 100 MHz
+/* ==================== Cycle Counter ==================== */
+// DWT cycle counter (enabled by systick_init), read inline for hot paths.
+// The core register macros here and in systick.c may be predefined to use
+// another register backend (e.g., a host-side mock).
+#ifndef DWT_CYCCNT
+#define DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004)
+#endif
+
+/* ==================== Types ==================== */
+// Function called from SysTick_Handler on every 1ms tick
+typedef void (*systick_callback_t)(void);
+
+// Returns milliseconds until the caller next needs the CPU awake
+// (SYSTICK_NO_DEADLINE if it has nothing scheduled)
+typedef uint32_t (*systick_deadline_t)(void);
+
+#define SYSTICK_NO_DEADLINE     0xFFFFFFFFUL
+
+// Maximum number of registered deadline providers
+#ifndef SYSTICK_MAX_DEADLINES
+#define SYSTICK_MAX_DEADLINES   4
+#endif
+
+// Maximum number of registered tick callbacks
+#ifndef SYSTICK_MAX_CALLBACKS
+#define SYSTICK_MAX_CALLBACKS   4
 #endif
 
 /* ==================== Functions ==================== */
 
 /**
  * @brief Initialize SysTick timer for 1ms tick
- * @param cpu_freq_hz CPU frequency in Hz (e.g., 100000000 for 100MHz)
- * @note Call this once at startup before using delay functions
- * @example systick_init(100000000);  // 100 MHz
+ * @note Call this once at startup before using delay functions. The tick
+ *       rate comes from clock_get_cpu() and follows clock_set_cpu() changes.
+ * @example systick_init();
  */
-void systick_init(uint32_t cpu_freq_hz);
+void systick_init(void);
 
 /**
  * @brief Delay for specified milliseconds (blocking)
@@ -50,10 +72,79 @@ uint32_t millis(void);
 /**
  * @brief Get microsecond counter (high resolution)
  * @return Microseconds elapsed (wraps around after ~71 minutes)
- * @note Uses SysTick current value for sub-millisecond precision
+ * @note Uses SysTick current value for sub-millisecond precision.
+ *       Lock-free and division-free, safe to call from any ISR.
  */
 uint32_t micros(void);
 
+/**
+ * @brief Get CPU cycle counter (DWT CYCCNT)
+ * @return Core clock cycles elapsed (wraps around, use differences)
+ * @example uint32_t t0 = cycles(); work(); uint32_t spent = cycles() - t0;
+ */
+static inline uint32_t cycles(void) {
+    return DWT_CYCCNT;
+}
+
+/**
+ * @brief Get number of CPU cycles per microsecond
+ * @return Cycles per microsecond at the current CPU clock
+ * @example uint32_t us = (cycles() - t0) / cycles_per_us();
+ */
+uint32_t cycles_per_us(void);
+
+/**
+ * @brief Add the ticks lost while interrupts were disabled for a long time
+ * @param cycles Length of the masked section, measured with cycles()
+ * @note Call before re-enabling interrupts. The counter keeps running
+ *       meanwhile, so its reloads are counted: one is still pending and
+ *       SysTick_Handler takes it, the others go straight to millis().
+ *       The tick callbacks run once for all of them.
+ * @example t0 = cycles(); rom_call(); systick_catch_up(cycles() - t0);
+ */
+void systick_catch_up(uint32_t cycles);
+
+/**
+ * @brief Register a function to run on every 1ms tick
+ * @param callback Function to call from SysTick_Handler
+ * @return 0 on success, -1 if SYSTICK_MAX_CALLBACKS are already registered
+ * @note Runs in interrupt context, keep it short and never block.
+ *       Callbacks run in registration order.
+ * @example systick_attach(swtimer_tick);
+ */
+int systick_attach(systick_callback_t callback);
+
+/**
+ * @brief Register a deadline provider consulted by systick_idle()
+ * @param deadline Function returning ms until its next needed wake-up
+ * @return 0 on success, -1 if SYSTICK_MAX_DEADLINES are already registered
+ */
+int systick_add_deadline(systick_deadline_t deadline);
+
+/**
+ * @brief Get the earliest deadline of all registered providers
+ * @return Milliseconds until the next needed wake-up, or SYSTICK_NO_DEADLINE
+ */
+uint32_t systick_next_deadline(void);
+
+/**
+ * @brief Sleep (WFI) until the next deadline or any interrupt
+ * @note Tickless: when the next deadline is more than 2ms away, the ms in
+ *       progress ends as usual and the following SysTick period spans the
+ *       rest of the interval. The counter is never stopped, so a sleep to
+ *       the deadline keeps millis() exact. An earlier wake cuts the period
+ *       at the next ms boundary. Where the cut lands is measured with
+ *       cycles(), so the few cycles of reprogramming are learned and the
+ *       ticks stay on the ms boundaries. millis() is corrected on wake and
+ *       the tick callbacks run once.
+ *       Call from the main loop only.
+ * @note May be called with interrupts masked (still returns on any pending
+ *       interrupt, possibly with them enabled), which closes the
+ *       check-then-sleep race for callers
+ * @example while(1) { do_work(); systick_idle(); }
+ */
+void systick_idle(void);
+
 /* ==================== Arduino-Style Aliases ==================== */
 #define delay(ms)  delay_ms(ms)
 #define delayMicroseconds(us)  delay_us(us)
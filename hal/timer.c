@@ -0,0 +1,217 @@
+/**
+ * @file timer.c
+ * @brief 32-bit hardware timer HAL implementation
+ */
+
+#include "timer.h"
+#include "gpio.h"
+#include "clock.h"
+#include "diag.h"
+#include <lpc17xx.h>
+
+/* ==================== Register Bits ==================== */
+#define TCR_ENABLE      (1 << 0)
+#define TCR_RESET       (1 << 1)
+#define IR_ALL          0x3F
+
+/* ==================== Driver State ==================== */
+static volatile timer_callback_t timer_callbacks[4][TIMER_SOURCES];
+static uint32_t timer_tick_hz[4];  // Requested counter rate, 0 = not initialized
+
+// PCLKSEL field of each timer
+static const clock_periph_t timer_pclk[4] = {
+    CLOCK_PCLK_TIMER0, CLOCK_PCLK_TIMER1, CLOCK_PCLK_TIMER2, CLOCK_PCLK_TIMER3
+};
+
+// CAPn.0 / CAPn.1 pins, all on PINSEL function 3
+static const uint8_t capture_pins[4][2] = {
+    { GPIO_PIN(1, 26), GPIO_PIN(1, 27) },  // TIMER0
+    { GPIO_PIN(1, 18), GPIO_PIN(1, 19) },  // TIMER1
+    { GPIO_PIN(0, 4),  GPIO_PIN(0, 5)  },  // TIMER2
+    { GPIO_PIN(0, 23), GPIO_PIN(0, 24) }   // TIMER3
+};
+
+/* ==================== Helper Functions ==================== */
+
+static LPC_TIM_TypeDef* get_timer_base(timer_num_t timer) {
+    switch(timer) {
+        case TIMER_0: return LPC_TIM0;
+        case TIMER_1: return LPC_TIM1;
+        case TIMER_2: return LPC_TIM2;
+        case TIMER_3: return LPC_TIM3;
+        default: return LPC_TIM0;
+    }
+}
+
+static void power_on_timer(timer_num_t timer) {
+    switch(timer) {
+        case TIMER_0: LPC_SC->PCONP |= (1<<1); break;
+        case TIMER_1: LPC_SC->PCONP |= (1<<2); break;
+        case TIMER_2: LPC_SC->PCONP |= (1<<22); break;
+        case TIMER_3: LPC_SC->PCONP |= (1<<23); break;
+    }
+    clock_set_pclk(timer_pclk[timer], 1);  // PCLK = CCLK
+}
+
+static uint32_t calc_prescale(timer_num_t timer) {
+    return (clock_get_pclk(timer_pclk[timer]) / timer_tick_hz[timer]) - 1;
+}
+
+// Clock change callback: keep every running timebase at its tick rate
+static void timer_clock_changed(uint32_t cpu_hz) {
+    (void)cpu_hz;
+    for(uint8_t timer = 0; timer < 4; timer++) {
+        if(timer_tick_hz[timer]) {
+            LPC_TIM_TypeDef *TIMx = get_timer_base((timer_num_t)timer);
+            TIMx->PR = calc_prescale((timer_num_t)timer);
+            TIMx->PC = 0;
+        }
+    }
+}
+
+static volatile uint32_t *get_match_reg(LPC_TIM_TypeDef *TIMx, uint8_t channel) {
+    return &TIMx->MR0 + channel;  // MR0-MR3 are consecutive
+}
+
+#if DIAG_ENABLE
+// Cycles since the earliest pending match or captured edge
+static uint32_t timer_irq_late(LPC_TIM_TypeDef *TIMx) {
+    uint32_t pending = TIMx->IR & IR_ALL;
+    uint32_t tc = TIMx->TC;
+    uint32_t ticks = 0;
+
+    for(uint8_t source = 0; source < TIMER_SOURCES; source++) {
+        if(!(pending & (1UL << source))) {
+            continue;
+        }
+
+        uint32_t since;
+        if(source >= TIMER_CAPTURE0) {
+            since = tc - (&TIMx->CR0)[source - TIMER_CAPTURE0];
+        } else if((TIMx->MCR >> (source * 3)) & TIMER_MATCH_RESET) {
+            since = tc;  // Restarted from 0 at the match
+        } else {
+            since = tc - *get_match_reg(TIMx, source);
+        }
+        if(since > ticks) {
+            ticks = since;
+        }
+    }
+    return ticks * (TIMx->PR + 1) + TIMx->PC;
+}
+#endif
+
+// Shared interrupt handler body: run the callback of every pending source
+static void timer_irq(timer_num_t timer) {
+    LPC_TIM_TypeDef *TIMx = get_timer_base(timer);
+    DIAG_IRQ_ENTER(DIAG_IRQ_TIMER0 + timer, timer_irq_late(TIMx));
+    uint32_t pending = TIMx->IR & IR_ALL;
+
+    TIMx->IR = pending;  // Write 1 to clear
+
+    while(pending) {
+        uint8_t source = 31 - __CLZ(pending);
+        pending &= ~(1UL << source);
+
+        timer_callback_t callback = timer_callbacks[timer][source];
+        if(callback) {
+            callback(timer, (timer_source_t)source);
+        }
+    }
+    DIAG_IRQ_EXIT(DIAG_IRQ_TIMER0 + timer);
+}
+
+/* ==================== Interrupt Handlers ==================== */
+
+void TIMER0_IRQHandler(void) { timer_irq(TIMER_0); }
+void TIMER1_IRQHandler(void) { timer_irq(TIMER_1); }
+void TIMER2_IRQHandler(void) { timer_irq(TIMER_2); }
+void TIMER3_IRQHandler(void) { timer_irq(TIMER_3); }
+
+/* ==================== Public Functions ==================== */
+
+void timer_init(timer_num_t timer, uint32_t tick_hz) {
+    LPC_TIM_TypeDef *TIMx = get_timer_base(timer);
+    static bool clock_attached = false;
+
+    // 1. Power on, PCLK = CCLK, follow CPU clock changes
+    power_on_timer(timer);
+    if(!clock_attached) {
+        clock_attach(timer_clock_changed);
+        clock_attached = true;
+    }
+    timer_tick_hz[timer] = tick_hz;
+
+    // 2. Hold in reset while configuring
+    TIMx->TCR = TCR_RESET;
+    TIMx->CTCR = 0;                          // Timer mode (count PCLK)
+    TIMx->PR = calc_prescale(timer);         // Prescale to tick_hz
+    TIMx->MCR = 0;
+    TIMx->CCR = 0;
+    TIMx->IR = IR_ALL;
+
+    // 3. Enable interrupt and start free-running
+    NVIC_EnableIRQ((IRQn_Type)(TIMER0_IRQn + timer));
+    TIMx->TCR = TCR_ENABLE;
+}
+
+void timer_start(timer_num_t timer) {
+    get_timer_base(timer)->TCR = TCR_ENABLE;
+}
+
+void timer_stop(timer_num_t timer) {
+    get_timer_base(timer)->TCR = 0;
+}
+
+void timer_reset(timer_num_t timer) {
+    LPC_TIM_TypeDef *TIMx = get_timer_base(timer);
+    uint32_t running = TIMx->TCR & TCR_ENABLE;
+
+    TIMx->TCR = TCR_RESET;
+    TIMx->TCR = running;
+}
+
+uint32_t timer_read(timer_num_t timer) {
+    return get_timer_base(timer)->TC;
+}
+
+void timer_set_match(timer_num_t timer, uint8_t channel, uint32_t ticks,
+                     uint8_t actions, timer_callback_t callback) {
+    LPC_TIM_TypeDef *TIMx = get_timer_base(timer);
+    uint8_t shift = channel * 3;  // MRnI, MRnR, MRnS
+
+    timer_callbacks[timer][channel] = callback;
+    *get_match_reg(TIMx, channel) = ticks;
+    TIMx->IR = 1UL << channel;
+    TIMx->MCR = (TIMx->MCR & ~(7UL << shift)) | ((uint32_t)(actions & 7) << shift);
+}
+
+void timer_clear_match(timer_num_t timer, uint8_t channel) {
+    LPC_TIM_TypeDef *TIMx = get_timer_base(timer);
+
+    TIMx->MCR &= ~(7UL << (channel * 3));
+    TIMx->IR = 1UL << channel;
+    timer_callbacks[timer][channel] = 0;
+}
+
+void timer_set_capture(timer_num_t timer, uint8_t channel, timer_edge_t edge,
+                       timer_callback_t callback) {
+    LPC_TIM_TypeDef *TIMx = get_timer_base(timer);
+    uint8_t shift = channel * 3;  // CAPnRE, CAPnFE, CAPnI
+    uint32_t bits = edge & 3;
+    const gpio_pin_cfg_t pin = { capture_pins[timer][channel], 3, GPIO_INPUT, GPIO_PULL_NONE, GPIO_LOW };
+
+    gpio_config_table(&pin, 1);
+    timer_callbacks[timer][TIMER_CAPTURE0 + channel] = callback;
+
+    if(callback) {
+        bits |= 4;  // Interrupt on capture
+    }
+    TIMx->IR = 1UL << (TIMER_CAPTURE0 + channel);
+    TIMx->CCR = (TIMx->CCR & ~(7UL << shift)) | (bits << shift);
+}
+
+uint32_t timer_capture_value(timer_num_t timer, uint8_t channel) {
+    LPC_TIM_TypeDef *TIMx = get_timer_base(timer);
+    return channel ? TIMx->CR1 : TIMx->CR0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file timer.h
+ * @brief 32-bit hardware timer HAL (TIMER0-3) for LPC1768
+ * @note Free-running counter with match interrupts and capture timestamps
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ==================== Timer Selection ==================== */
+typedef enum {
+    TIMER_0 = 0,
+    TIMER_1 = 1,
+    TIMER_2 = 2,
+    TIMER_3 = 3
+} timer_num_t;
+
+/* ==================== Interrupt Sources ==================== */
+// Values are the IR bit positions
+typedef enum {
+    TIMER_MATCH0   = 0,
+    TIMER_MATCH1   = 1,
+    TIMER_MATCH2   = 2,
+    TIMER_MATCH3   = 3,
+    TIMER_CAPTURE0 = 4,
+    TIMER_CAPTURE1 = 5,
+    TIMER_SOURCES
+} timer_source_t;
+
+/* ==================== Match Actions ==================== */
+#define TIMER_MATCH_INT     (1 << 0)  // Interrupt (callback) on match
+#define TIMER_MATCH_RESET   (1 << 1)  // Reset counter on match (periodic)
+#define TIMER_MATCH_STOP    (1 << 2)  // Stop counter on match (one-shot)
+
+/* ==================== Capture Edges ==================== */
+typedef enum {
+    TIMER_CAP_RISING  = 1,
+    TIMER_CAP_FALLING = 2,
+    TIMER_CAP_BOTH    = 3
+} timer_edge_t;
+
+/* ==================== Types ==================== */
+// Called from TIMERn_IRQHandler for match and capture interrupts
+typedef void (*timer_callback_t)(timer_num_t timer, timer_source_t source);
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Power on a timer and start it free-running
+ * @param timer Timer number (0-3)
+ * @param tick_hz Counter rate in Hz (e.g., 1000000 for 1us ticks)
+ * @note Clocked from CCLK, the prescaler follows clock_set_cpu() changes
+ * @example timer_init(TIMER_1, 1000000);  // 1 MHz timebase
+ */
+void timer_init(timer_num_t timer, uint32_t tick_hz);
+
+/**
+ * @brief Start counting
+ * @param timer Timer number
+ */
+void timer_start(timer_num_t timer);
+
+/**
+ * @brief Stop counting (counter keeps its value)
+ * @param timer Timer number
+ */
+void timer_stop(timer_num_t timer);
+
+/**
+ * @brief Reset counter to 0
+ * @param timer Timer number
+ */
+void timer_reset(timer_num_t timer);
+
+/**
+ * @brief Read the free-running counter
+ * @param timer Timer number
+ * @return Counter value in ticks (wraps at 2^32)
+ */
+uint32_t timer_read(timer_num_t timer);
+
+/**
+ * @brief Program a match channel
+ * @param timer Timer number
+ * @param channel Match channel 0-3
+ * @param ticks Counter value to match
+ * @param actions TIMER_MATCH_INT | TIMER_MATCH_RESET | TIMER_MATCH_STOP
+ * @param callback Called on match when TIMER_MATCH_INT is set (may be NULL)
+ * @example timer_set_match(TIMER_1, 0, 999, TIMER_MATCH_INT | TIMER_MATCH_RESET, tick);
+ */
+void timer_set_match(timer_num_t timer, uint8_t channel, uint32_t ticks,
+                     uint8_t actions, timer_callback_t callback);
+
+/**
+ * @brief Disable a match channel
+ * @param timer Timer number
+ * @param channel Match channel 0-3
+ */
+void timer_clear_match(timer_num_t timer, uint8_t channel);
+
+/**
+ * @brief Timestamp edges on a capture pin (CAPn.0/CAPn.1)
+ * @param timer Timer number
+ * @param channel Capture channel 0-1 (pin function is selected here)
+ * @param edge Edges that latch the counter
+ * @param callback Called on capture (may be NULL to poll timer_capture_value)
+ */
+void timer_set_capture(timer_num_t timer, uint8_t channel, timer_edge_t edge,
+                       timer_callback_t callback);
+
+/**
+ * @brief Read the last captured counter value
+ * @param timer Timer number
+ * @param channel Capture channel 0-1
+ */
+uint32_t timer_capture_value(timer_num_t timer, uint8_t channel);
+
+#endif // TIMER_H
@@ -4,9 +4,13 @@
  */
 
 #include "uart.h"
+#include "ringbuf.h"
+#include "event.h"
+#include "dma.h"
+#include "clock.h"
+#include "profile.h"
+#include "diag.h"
 #include <lpc17xx.h>
-#include <stdarg.h>
-#include <stdio.h>
 
 /* ==================== UART Register Structure ==================== */
 typedef struct {
@@ -35,6 +39,51 @@ typedef struct {
     volatile uint32_t TER;      // Transmit Enable
 } LPC_UART_TypeDef_Custom;
 
+/* ==================== Register Bits ==================== */
+#define LSR_RDR         (1<<0)   // Receiver data ready
+#define LSR_THRE        (1<<5)   // Transmit holding register empty
+#define LSR_TEMT        (1<<6)   // Transmitter empty (FIFO and shift register)
+#define IER_RBR         (1<<0)   // RX data available / character timeout
+#define IER_THRE        (1<<1)   // THR empty
+#define IIR_NO_PENDING  (1<<0)   // No interrupt pending
+#define FCR_DMA_MODE    (1<<3)   // Assert DMA requests
+#define FCR_RX_TRIG_8   (2<<6)   // RX interrupt at 8 bytes in FIFO
+#define UART_FIFO_SIZE  16
+#define LCR_DLAB        (1<<7)   // Divisor latch access
+#define BAUD_MAX_ERROR_PCT  2    // Worst acceptable baud rate error
+
+// GPDMA channel used for uart_write_dma() on each UART
+#define UART_DMA_CHANNEL(uart)  (4 + (uart))
+#define UART_DMA_QUEUE          2   // Double buffering
+
+// PCLKSEL field of each UART
+static const clock_periph_t uart_pclk[4] = {
+    CLOCK_PCLK_UART0, CLOCK_PCLK_UART1, CLOCK_PCLK_UART2, CLOCK_PCLK_UART3
+};
+
+/* ==================== Driver State ==================== */
+// TX: main enqueues, ISR drains. RX: ISR enqueues, main drains.
+static uint8_t tx_storage[4][UART_TX_BUFFER_SIZE];
+static uint8_t rx_storage[4][UART_RX_BUFFER_SIZE];
+static ringbuf_t tx_ring[4];
+static ringbuf_t rx_ring[4];
+
+// DMA: main queues buffers, the UART ISR starts them and retires them
+typedef struct {
+    const void *buf;
+    uint16_t len;
+    uart_dma_callback_t callback;
+} uart_dma_req_t;
+
+static uart_dma_req_t dma_storage[4][UART_DMA_QUEUE];
+static ringbuf_t dma_queue[4];
+static volatile bool dma_active[4];  // Head of dma_queue is on the wire
+static volatile bool dma_done[4];    // Set by DMA ISR, cleared by UART ISR
+static volatile bool dma_error[4];   // The finished buffer hit a bus error
+
+static uint32_t uart_baud[4];        // Requested baud rate, 0 = not initialized
+static uart_text_hook_t text_hook[4];  // Text output redirect, 0 = TX buffer
+
 /* ==================== Helper Functions ==================== */
 
 static LPC_UART_TypeDef_Custom* get_uart_base(uart_num_t uart) {
@@ -74,9 +123,163 @@ static void power_on_uart(uart_num_t uart) {
         case UART_1: LPC_SC->PCONP |= (1<<4); break;
         case UART_2: LPC_SC->PCONP |= (1<<24); break;
         case UART_3: LPC_SC->PCONP |= (1<<25); break;
+        default: return;
+    }
+    clock_set_pclk(uart_pclk[uart], 1);  // PCLK = CCLK, finest baud resolution
+}
+
+/**
+ * Find the divisor and fractional divider closest to the requested baud:
+ *   baud = pclk / (16 * DL * (1 + DIVADDVAL / MULVAL))
+ * Tries every MULVAL 1-15 / DIVADDVAL 0..MULVAL-1 with the nearest DL
+ * (DL >= 3 whenever DIVADDVAL > 0, as the fractional divider requires).
+ */
+static uint32_t calc_baud_divisor(uint32_t pclk, uint32_t baud,
+                                  uint16_t *dl_out, uint8_t *fdr_out) {
+    uint32_t best_baud = 0;
+    uint32_t best_err = 0xFFFFFFFF;
+
+    for(uint32_t mul = 1; mul <= 15; mul++) {
+        for(uint32_t add = 0; add < mul; add++) {
+            uint64_t num = (uint64_t)pclk * mul;
+            uint64_t den = (uint64_t)16 * baud * (mul + add);
+            uint32_t dl = (uint32_t)((num + den / 2) / den);  // Round to nearest
+
+            if(dl > 0xFFFF || dl < ((add > 0) ? 3 : 1)) {
+                continue;
+            }
+
+            uint32_t actual = (uint32_t)(num / ((uint64_t)16 * dl * (mul + add)));
+            uint32_t err = (actual > baud) ? actual - baud : baud - actual;
+
+            if(err < best_err) {
+                best_err = err;
+                best_baud = actual;
+                *dl_out = (uint16_t)dl;
+                *fdr_out = (uint8_t)((mul << 4) | add);
+            }
+        }
+    }
+
+    // Beyond a few percent one end misreads the stop bit
+    if((uint64_t)best_err * 100 > (uint64_t)baud * BAUD_MAX_ERROR_PCT) {
+        return 0;
+    }
+    return best_baud;
+}
+
+// Clock change callback: recompute the divisors of every open port
+static void uart_clock_changed(uint32_t cpu_hz) {
+    (void)cpu_hz;
+    for(uint8_t uart = 0; uart < 4; uart++) {
+        if(uart_baud[uart]) {
+            uart_set_baud((uart_num_t)uart, uart_baud[uart]);
+        }
+    }
+}
+
+static IRQn_Type get_uart_irq(uart_num_t uart) {
+    return (IRQn_Type)(UART0_IRQn + uart);
+}
+
+// Load up to one FIFO worth of queued bytes (ISR context only)
+static void uart_fill_fifo(uart_num_t uart, LPC_UART_TypeDef_Custom *UARTx) {
+    if(dma_active[uart]) {
+        return;  // DMA owns THR until it finishes
+    }
+    
+    uint8_t chunk[UART_FIFO_SIZE];
+    size_t n = ringbuf_read(&tx_ring[uart], chunk, sizeof(chunk));
+    
+    for(size_t i = 0; i < n; i++) {
+        UARTx->THR = chunk[i];
+    }
+    
+    if(n > 0 && ringbuf_empty(&tx_ring[uart])) {
+        event_post(EVENT_SRC_UART, EVENT_UART_TX, uart, 0);
+    }
+}
+
+// DMA terminal count: hand the retire/restart work to the UART ISR
+static void uart_dma_complete(uint8_t channel, bool error) {
+    uart_num_t uart = (uart_num_t)(channel - UART_DMA_CHANNEL(0));
+    
+    dma_error[uart] = error;
+    dma_done[uart] = true;
+    NVIC_SetPendingIRQ(get_uart_irq(uart));
+}
+
+// Retire a finished DMA buffer and start the next one (UART ISR only)
+static void uart_service_dma(uart_num_t uart, LPC_UART_TypeDef_Custom *UARTx) {
+    if(dma_done[uart]) {
+        uart_dma_req_t *req = (uart_dma_req_t *)ringbuf_peek(&dma_queue[uart]);
+        dma_done[uart] = false;
+        dma_active[uart] = false;
+        ringbuf_skip(&dma_queue[uart]);
+        
+        if(req->callback) {
+            req->callback(uart, req->buf, dma_error[uart]);
+        }
+    }
+    
+    if(!dma_active[uart]) {
+        uart_dma_req_t *next = (uart_dma_req_t *)ringbuf_peek(&dma_queue[uart]);
+        if(next) {
+            uart_fill_fifo(uart, UARTx);  // Ring bytes go out ahead of the buffer
+            dma_active[uart] = dma_start(UART_DMA_CHANNEL(uart), DMA_M2P,
+                                         (dma_req_t)(DMA_REQ_UART0_TX + 2 * uart),
+                                         next->buf, &UARTx->THR, next->len, uart_dma_complete);
+            if(!dma_active[uart]) {
+                // Channel not released yet: retry on the next entry
+                NVIC_SetPendingIRQ(get_uart_irq(uart));
+            }
+        }
+    }
+}
+
+// Shared interrupt handler body for all UARTs
+static void uart_irq(uart_num_t uart) {
+    DIAG_IRQ_ENTER(DIAG_IRQ_UART0 + uart, DIAG_NO_LATENCY);
+    PROFILE_ENTER(uart_irq);  // One probe for all ports (same NVIC priority)
+    LPC_UART_TypeDef_Custom *UARTx = get_uart_base(uart);
+    
+    // Reading IIR acknowledges THRE, RX sources clear when RBR is drained
+    while((UARTx->IIR & IIR_NO_PENDING) == 0) {
+        bool was_empty = ringbuf_empty(&rx_ring[uart]);
+        bool received = false;
+        
+        while(UARTx->LSR & LSR_RDR) {
+            uint8_t data = UARTx->RBR & 0xFF;
+            ringbuf_put(&rx_ring[uart], &data);  // Dropped if full
+            received = true;
+        }
+        
+        if(received && was_empty) {
+            event_post(EVENT_SRC_UART, EVENT_UART_RX, uart, ringbuf_count(&rx_ring[uart]));
+        }
+        
+        if(UARTx->LSR & LSR_THRE) {
+            uart_fill_fifo(uart, UARTx);
+        }
     }
+    
+    // TX was idle when main queued data (pended, no IIR source)
+    if(UARTx->LSR & LSR_THRE) {
+        uart_fill_fifo(uart, UARTx);
+    }
+    
+    uart_service_dma(uart, UARTx);
+    PROFILE_EXIT(uart_irq);
+    DIAG_IRQ_EXIT(DIAG_IRQ_UART0 + uart);
 }
 
+/* ==================== Interrupt Handlers ==================== */
+
+void UART0_IRQHandler(void) { uart_irq(UART_0); }
+void UART1_IRQHandler(void) { uart_irq(UART_1); }
+void UART2_IRQHandler(void) { uart_irq(UART_2); }
+void UART3_IRQHandler(void) { uart_irq(UART_3); }
+
 /* ==================== Public Functions ==================== */
 
 void uart_init(uart_num_t uart, uint32_t baud) {
@@ -88,63 +291,285 @@ void uart_init(uart_num_t uart, uint32_t baud) {
     // 2. Configure pins
     configure_uart_pins(uart);
     
-    // 3. Set PCLK to CCLK/4 = 25MHz (assuming 100MHz CPU)
-    uint32_t pclk = 25000000;
-    
-    // 4. Calculate divisor (assuming FDR = 1.0)
-    uint32_t divisor = pclk / (16 * baud);
-    
-    // 5. Enable DLAB (Divisor Latch Access Bit)
-    UARTx->LCR = (1<<7);
-    
-    // 6. Set divisor
-    UARTx->DLL = divisor & 0xFF;
-    UARTx->DLM = (divisor >> 8) & 0xFF;
-    
-    // 7. Configure: 8-N-1 (8 data bits, no parity, 1 stop bit)
+    // 3. Configure: 8-N-1 (8 data bits, no parity, 1 stop bit)
     UARTx->LCR = 0x03;  // DLAB=0, 8-bit data
     
-    // 8. Enable FIFO, reset TX/RX FIFOs
-    UARTx->FCR = 0x07;
+    // 4. Divisor and fractional divider from the real PCLK, kept in step
+    //    with CPU clock changes
+    static bool clock_attached = false;
+    if(!clock_attached) {
+        clock_attach(uart_clock_changed);
+        clock_attached = true;
+    }
+    uart_set_baud(uart, baud);
+    
+    // 5. Enable FIFO, reset TX/RX FIFOs, RX trigger at 8 bytes
+    UARTx->FCR = 0x07 | FCR_DMA_MODE | FCR_RX_TRIG_8;
     
-    // 9. Enable transmission
+    // 6. Enable transmission
     UARTx->TER = 0x80;
+    
+    // 7. Set up buffers and RX/THRE interrupts
+    ringbuf_init(&tx_ring[uart], tx_storage[uart], 1, UART_TX_BUFFER_SIZE);
+    ringbuf_init(&rx_ring[uart], rx_storage[uart], 1, UART_RX_BUFFER_SIZE);
+    ringbuf_init(&dma_queue[uart], dma_storage[uart], sizeof(uart_dma_req_t), UART_DMA_QUEUE);
+    dma_active[uart] = false;
+    dma_done[uart] = false;
+    dma_init();  // For uart_write_dma()
+    UARTx->IER = IER_RBR | IER_THRE;
+    NVIC_EnableIRQ(get_uart_irq(uart));
 }
 
-void uart_putc(uart_num_t uart, char data) {
+uint32_t uart_set_baud(uart_num_t uart, uint32_t baud) {
     LPC_UART_TypeDef_Custom *UARTx = get_uart_base(uart);
+    uint16_t dl = 0;
+    uint8_t fdr = 0x10;  // MULVAL=1, DIVADDVAL=0 (no fractional division)
+    uint32_t actual = calc_baud_divisor(clock_get_pclk(uart_pclk[uart]), baud, &dl, &fdr);
+
+    uart_baud[uart] = baud;
+    if(actual == 0) {
+        return 0;  // Baud rate out of range for this PCLK
+    }
+
+    // Divisor latches are behind DLAB, keep the line format
+    uint32_t lcr = UARTx->LCR & ~LCR_DLAB;
+    UARTx->LCR = lcr | LCR_DLAB;
+    UARTx->DLL = dl & 0xFF;
+    UARTx->DLM = dl >> 8;
+    UARTx->FDR = fdr;
+    UARTx->LCR = lcr;
+
+    return actual;
+}
+
+size_t uart_write(uart_num_t uart, const void *buf, size_t len) {
+    size_t n = ringbuf_write(&tx_ring[uart], (const uint8_t *)buf, len);
+    
+    // Let the ISR (sole TX consumer) start the FIFO if the line is idle
+    if(n > 0) {
+        NVIC_SetPendingIRQ(get_uart_irq(uart));
+    }
+    return n;
+}
+
+bool uart_write_dma(uart_num_t uart, const void *buf, size_t len, uart_dma_callback_t callback) {
+    if(len == 0 || len > DMA_MAX_TRANSFER) {
+        return false;
+    }
+    
+    uart_dma_req_t req = { buf, (uint16_t)len, callback };
     
-    // Wait until THR is empty (bit 5 of LSR)
-    while((UARTx->LSR & (1<<5)) == 0);
+    if(!ringbuf_put(&dma_queue[uart], &req)) {
+        return false;  // Both buffers in use
+    }
     
-    UARTx->THR = data;
+    NVIC_SetPendingIRQ(get_uart_irq(uart));
+    return true;
 }
 
-void uart_puts(uart_num_t uart, const char *str) {
-    while(*str) {
-        uart_putc(uart, *str++);
+size_t uart_read(uart_num_t uart, void *buf, size_t len) {
+    return ringbuf_read(&rx_ring[uart], (uint8_t *)buf, len);
+}
+
+size_t uart_tx_space(uart_num_t uart) {
+    return ringbuf_space(&tx_ring[uart]);
+}
+
+bool uart_tx_idle(uart_num_t uart) {
+    return ringbuf_empty(&tx_ring[uart]) && ringbuf_empty(&dma_queue[uart])
+        && (get_uart_base(uart)->LSR & LSR_TEMT);
+}
+
+void uart_set_text_hook(uart_num_t uart, uart_text_hook_t hook) {
+    text_hook[uart] = hook;
+}
+
+// Text without the end-of-call mark, so one uart_printf() stays one piece
+static void text_write(uart_num_t uart, const char *str, size_t len) {
+    if(text_hook[uart]) {
+        text_hook[uart](uart, str, len);
+        return;
+    }
+    
+    // Wait only while the TX buffer is full
+    while(len > 0) {
+        size_t n = uart_write(uart, str, len);
+        str += n;
+        len -= n;
     }
 }
 
+static void text_end(uart_num_t uart) {
+    if(text_hook[uart]) {
+        text_hook[uart](uart, NULL, 0);
+    }
+}
+
+static void text_putc(uart_num_t uart, char data) {
+    text_write(uart, &data, 1);
+}
+
+void uart_putc(uart_num_t uart, char data) {
+    text_putc(uart, data);
+    text_end(uart);
+}
+
+void uart_puts(uart_num_t uart, const char *str) {
+    size_t len = 0;
+    while(str[len]) len++;
+    
+    text_write(uart, str, len);
+    text_end(uart);
+}
+
 char uart_getc(uart_num_t uart) {
-    LPC_UART_TypeDef_Custom *UARTx = get_uart_base(uart);
+    uint8_t data;
     
-    // Wait until data ready (bit 0 of LSR)
-    while((UARTx->LSR & (1<<0)) == 0);
+    // Wait until the ISR has received a byte
+    while(uart_read(uart, &data, 1) == 0);
     
-    return UARTx->RBR & 0xFF;
+    return (char)data;
 }
 
 bool uart_available(uart_num_t uart) {
-    LPC_UART_TypeDef_Custom *UARTx = get_uart_base(uart);
-    return (UARTx->LSR & (1<<0)) != 0;
+    return !ringbuf_empty(&rx_ring[uart]);
+}
+
+/* ==================== Formatted Output ==================== */
+
+// Emit digits of value in the given base with padding (digits built in a
+// 10-byte scratch array, the only buffer used by uart_printf)
+static void print_number(uart_num_t uart, uint32_t value, uint8_t base, bool upper,
+                         bool negative, uint8_t width, char pad, bool left) {
+    char digits[10];
+    uint8_t n = 0;
+    const char *hex = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    
+    do {
+        digits[n++] = hex[value % base];
+        value /= base;
+    } while(value);
+    
+    uint8_t len = n + (negative ? 1 : 0);
+    
+    if(negative && pad == '0') {
+        text_putc(uart, '-');  // Sign goes before zero padding
+    }
+    if(!left) {
+        for(; len < width; len++) text_putc(uart, pad);
+    }
+    if(negative && pad != '0') {
+        text_putc(uart, '-');
+    }
+    while(n) {
+        text_putc(uart, digits[--n]);
+    }
+    if(left) {
+        for(; len < width; len++) text_putc(uart, ' ');
+    }
+}
+
+void uart_vprintf(uart_num_t uart, const char *format, va_list args) {
+    while(*format) {
+        char c = *format++;
+        if(c != '%') {
+            text_putc(uart, c);
+            continue;
+        }
+        
+        // Flags, width, precision, length
+        bool left = false;
+        char pad = ' ';
+        uint8_t width = 0;
+        int8_t precision = -1;
+        
+        for(;; format++) {
+            if(*format == '-') left = true;
+            else if(*format == '0') pad = '0';
+            else break;
+        }
+        if(left) pad = ' ';
+        while(*format >= '0' && *format <= '9') {
+            width = width * 10 + (*format++ - '0');
+        }
+        if(*format == '.') {
+            precision = 0;
+            while(*++format >= '0' && *format <= '9') {
+                precision = precision * 10 + (*format - '0');
+            }
+        }
+        while(*format == 'l' || *format == 'h') format++;  // int and long are both 32-bit
+        
+        switch(c = *format++) {
+            case 'd':
+            case 'i': {
+                int32_t v = va_arg(args, int32_t);
+                uint32_t mag = (v < 0) ? 0u - (uint32_t)v : (uint32_t)v;
+                print_number(uart, mag, 10, false, v < 0, width, pad, left);
+                break;
+            }
+            case 'u':
+                print_number(uart, va_arg(args, uint32_t), 10, false, false, width, pad, left);
+                break;
+            case 'x':
+            case 'X':
+                print_number(uart, va_arg(args, uint32_t), 16, c == 'X', false, width, pad, left);
+                break;
+            case 'c':
+                text_putc(uart, (char)va_arg(args, int));
+                break;
+            case 's': {
+                const char *str = va_arg(args, const char *);
+                if(!str) str = "(null)";
+                size_t len = 0;
+                while(str[len]) len++;
+                if(!left) for(; len < width; len++) text_putc(uart, ' ');
+                text_write(uart, str, len);
+                if(left) for(; len < width; len++) text_putc(uart, ' ');
+                break;
+            }
+#if UART_PRINTF_FLOAT
+            case 'f': {
+                double v = va_arg(args, double);
+                bool negative = v < 0;
+                if(negative) v = -v;
+                if(precision < 0) precision = 6;
+                
+                // Round, then split into integer and fractional parts
+                double scale = 1.0;
+                for(int8_t i = 0; i < precision; i++) scale *= 10.0;
+                v += 0.5 / scale;
+                uint32_t whole = (uint32_t)v;
+                uint32_t frac = (uint32_t)((v - whole) * scale);
+                
+                uint8_t frac_len = precision ? precision + 1 : 0;  // Digits plus '.'
+                uint8_t int_width = (width > frac_len) ? width - frac_len : 0;
+                print_number(uart, whole, 10, false, negative, int_width, pad, false);
+                if(precision) {
+                    text_putc(uart, '.');
+                    print_number(uart, frac, 10, false, false, precision, '0', false);
+                }
+                break;
+            }
+#endif
+            case '%':
+                text_putc(uart, '%');
+                break;
+            case '\0':
+                text_end(uart);
+                return;  // Truncated conversion at end of string
+            default:
+                text_putc(uart, '%');  // Unknown conversion, print as-is
+                text_putc(uart, c);
+                break;
+        }
+    }
+    text_end(uart);
 }
 
 void uart_printf(uart_num_t uart, const char *format, ...) {
-    char buffer[256];
     va_list args;
     va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    uart_vprintf(uart, format, args);
     va_end(args);
-    uart_puts(uart, buffer);
-}
\ No newline at end of file
+}
@@ -8,6 +8,22 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+/* ==================== Configuration ==================== */
+// Per-port software buffer sizes (powers of 2)
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE  128
+#endif
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE  64
+#endif
+
+// Set to 1 to add %f to uart_printf() (pulls in soft-float code)
+#ifndef UART_PRINTF_FLOAT
+#define UART_PRINTF_FLOAT    0
+#endif
 
 /* ==================== UART Selection ==================== */
 typedef enum {
@@ -17,19 +33,99 @@ typedef enum {
     UART_3 = 3
 } uart_num_t;
 
+/* ==================== Types ==================== */
+// Called when a uart_write_dma() buffer may be reused (from ISR context).
+// error is set if the GPDMA stopped on a bus error: buf was not fully sent.
+typedef void (*uart_dma_callback_t)(uart_num_t uart, const void *buf, bool error);
+
+// Takes the text of uart_putc(), uart_puts() and uart_printf() instead of
+// the TX buffer (see uart_set_text_hook()). Each of those calls ends with
+// len = 0 (text NULL), so the hook can flush what it holds.
+typedef void (*uart_text_hook_t)(uart_num_t uart, const char *text, size_t len);
+
 /* ==================== Functions ==================== */
 
 /**
  * @brief Initialize UART
  * @param uart UART number (0-3)
- * @param baud Baud rate (e.g., 9600, 115200)
+ * @param baud Baud rate (e.g., 9600, 115200, 921600)
+ * @note TX and RX are interrupt driven through per-port ring buffers.
+ *       All UART IRQs must share one NVIC priority (single producer).
  */
 void uart_init(uart_num_t uart, uint32_t baud);
 
+/**
+ * @brief Set the baud rate from the current PCLK
+ * @param uart UART number
+ * @param baud Requested baud rate
+ * @return Baud rate actually achieved, 0 if not reachable
+ * @note Searches the fractional divider for the lowest error. Re-applied
+ *       automatically when clock_set_cpu() changes the CPU clock.
+ * @example uint32_t actual = uart_set_baud(UART_0, 460800);
+ */
+uint32_t uart_set_baud(uart_num_t uart, uint32_t baud);
+
+/**
+ * @brief Queue bytes for transmission (non-blocking)
+ * @param uart UART number
+ * @param buf Bytes to send
+ * @param len Number of bytes
+ * @return Number of bytes queued (less than len if the TX buffer is full)
+ */
+size_t uart_write(uart_num_t uart, const void *buf, size_t len);
+
+/**
+ * @brief Take received bytes (non-blocking)
+ * @param uart UART number
+ * @param buf Destination buffer
+ * @param len Maximum number of bytes
+ * @return Number of bytes read (0 if nothing received)
+ */
+size_t uart_read(uart_num_t uart, void *buf, size_t len);
+
+/**
+ * @brief Free space in the TX buffer
+ * @param uart UART number
+ * @return Bytes that uart_write() can accept without truncating
+ */
+size_t uart_tx_space(uart_num_t uart);
+
+/**
+ * @brief Check that everything queued has left the TX pin
+ * @param uart UART number
+ * @return true if the TX buffer, DMA queue and UART FIFO are all empty
+ * @note Check before stopping the clocks (e.g., deep sleep)
+ */
+bool uart_tx_idle(uart_num_t uart);
+
+/**
+ * @brief Send a buffer by GPDMA without copying it
+ * @param uart UART number
+ * @param buf Bytes to send (must stay untouched until callback runs)
+ * @param len Number of bytes (1 - 4095)
+ * @param callback Called when buf may be reused (may be NULL)
+ * @return false if two buffers are already queued or len is out of range
+ * @note Double-buffered: fill buffer B while buffer A drains, then queue B.
+ *       Bytes from uart_write() queued meanwhile are sent between buffers.
+ * @example uart_write_dma(UART_0, log_a, sizeof(log_a), log_done);
+ */
+bool uart_write_dma(uart_num_t uart, const void *buf, size_t len, uart_dma_callback_t callback);
+
+/**
+ * @brief Redirect the text output of a UART
+ * @param uart UART number
+ * @param hook Receiver of the text, 0 to queue it directly again
+ * @note uart_write() and uart_write_dma() are not affected, so a port
+ *       carrying binary frames can wrap its text in frames of its own
+ * @example uart_set_text_hook(UART_2, frame_text);
+ */
+void uart_set_text_hook(uart_num_t uart, uart_text_hook_t hook);
+
 /**
  * @brief Send single byte
  * @param uart UART number
  * @param data Byte to send
+ * @note Waits only while the TX buffer is full
  */
 void uart_putc(uart_num_t uart, char data);
 
@@ -37,6 +133,7 @@ void uart_putc(uart_num_t uart, char data);
  * @brief Send string
  * @param uart UART number
  * @param str Null-terminated string
+ * @note Waits only while the TX buffer is full
  */
 void uart_puts(uart_num_t uart, const char *str);
 
@@ -44,6 +141,7 @@ void uart_puts(uart_num_t uart, const char *str);
  * @brief Receive single byte (blocking)
  * @param uart UART number
  * @return Received byte
+ * @note Waits until the RX buffer holds a byte, prefer uart_read()
  */
 char uart_getc(uart_num_t uart);
 
@@ -58,9 +156,22 @@ bool uart_available(uart_num_t uart);
  * @brief Send formatted string (printf-style)
  * @param uart UART number
  * @param format Format string
+ * @note Supports %d %i %u %x %X %s %c %% with optional '-', '0', width and
+ *       'l' modifier, plus %f with precision when UART_PRINTF_FLOAT is 1.
+ *       Characters go straight into the TX buffer (or the text hook), no
+ *       intermediate buffer.
+ * @example uart_printf(UART_0, "t=%04u state=%d\n", timer_value, state);
  */
 void uart_printf(uart_num_t uart, const char *format, ...);
 
+/**
+ * @brief uart_printf() taking a va_list
+ * @param uart UART number
+ * @param format Format string
+ * @param args Argument list
+ */
+void uart_vprintf(uart_num_t uart, const char *format, va_list args);
+
 /* ==================== Arduino-Style Aliases ==================== */
 #define Serial uart_0_instance
 #define Serial_begin(baud) uart_init(UART_0, baud)
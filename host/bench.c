@@ -0,0 +1,73 @@
+/**
+ * @file bench.c
+ * @brief Shared harness of the host benchmarks
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "telemetry.h"
+#include "console.h"
+
+int app_main(void);
+
+#define BENCH_LINES         32      // Console lines queued at once
+
+static char lines[BENCH_LINES][CONSOLE_LINE_MAX + 2];
+static uint8_t line_count;
+
+/* ==================== Statistics ==================== */
+
+void bench_stat_add(bench_stat_t *s, uint64_t cycles) {
+    if(s->count == 0 || cycles < s->min) s->min = cycles;
+    if(cycles > s->max) s->max = cycles;
+    s->sum += cycles;
+    s->count++;
+}
+
+void bench_stat_print(const char *name, const bench_stat_t *s) {
+    double per_us = BENCH_CPU_HZ / 1e6;
+
+    if(s->count == 0) {
+        printf("%-28s no samples\n", name);
+        return;
+    }
+    printf("%-28s n=%-5u min %8.1f  avg %8.1f  max %8.1f us\n", name, (unsigned)s->count,
+           s->min / per_us, (double)s->sum / s->count / per_us, s->max / per_us);
+}
+
+/* ==================== Harness ==================== */
+
+static void firmware(void) {
+    app_main();
+}
+
+static void console_line(void *arg) {
+    const char *text = (const char *)arg;
+    mock_uart_rx(TELEMETRY_UART, text, strlen(text));
+}
+
+void bench_reset(void) {
+    mock_reset();
+    line_count = 0;
+}
+
+bool bench_run(uint32_t ms) {
+    return !mock_run(firmware, BENCH_MS(ms));
+}
+
+void bench_console_at(uint32_t ms, const char *line) {
+    if(line_count == BENCH_LINES || strlen(line) > CONSOLE_LINE_MAX) {
+        fprintf(stderr, "bench: console line dropped: %s\n", line);
+        return;
+    }
+    snprintf(lines[line_count], sizeof(lines[0]), "%s\r", line);
+    mock_at(BENCH_MS(ms), console_line, lines[line_count++]);
+}
+
+bool bench_check(const char *name, double value, double limit, bool at_most) {
+    bool ok = at_most ? value <= limit : value >= limit;
+
+    printf("%-28s %10.1f  %s %8.1f  %s\n", name, value, at_most ? "<=" : ">=", limit, ok ? "ok" : "FAIL");
+    return ok;
+}
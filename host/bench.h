@@ -0,0 +1,68 @@
+/**
+ * @file bench.h
+ * @brief Shared harness of the host benchmarks: boots main() on the mock
+ * @note Stimuli are queued with mock_at() before bench_run(), which runs
+ *       the firmware once for the whole scenario. Budgets are checked on
+ *       virtual cycles, so results are the same on every host.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mock.h"
+
+/* ==================== Configuration ==================== */
+#define BENCH_CPU_HZ        12000000UL   // Set by main(), PLL0 off
+
+// Conversions at the firmware's clock, valid before main() has set it
+#define BENCH_MS(ms)        ((uint64_t)(ms) * (BENCH_CPU_HZ / 1000))
+#define BENCH_US(us)        ((uint64_t)(us) * (BENCH_CPU_HZ / 1000000))
+
+/* ==================== Statistics ==================== */
+typedef struct {
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+    uint32_t count;
+} bench_stat_t;
+
+void bench_stat_add(bench_stat_t *s, uint64_t cycles);
+
+/**
+ * @brief Print a line of min/avg/max in microseconds
+ * @param name Label
+ * @param s Samples in cycles
+ */
+void bench_stat_print(const char *name, const bench_stat_t *s);
+
+/* ==================== Harness ==================== */
+
+/**
+ * @brief Power-on reset of the mock, with stimuli queued afterwards
+ */
+void bench_reset(void);
+
+/**
+ * @brief Run main() from reset for a duration
+ * @param ms Virtual milliseconds
+ * @return false if main() returned (it never should)
+ */
+bool bench_run(uint32_t ms);
+
+// Queue console input on the telemetry UART at a time from reset
+void bench_console_at(uint32_t ms, const char *line);
+
+/**
+ * @brief Compare a result with its budget and print the verdict
+ * @param name Label
+ * @param value Measured
+ * @param limit Budget
+ * @param at_most true if value must not exceed limit, false for a minimum
+ * @return true if within budget
+ * @example ok &= bench_check("max latency us", max_us, 200, true);
+ */
+bool bench_check(const char *name, double value, double limit, bool at_most);
+
+#endif // BENCH_H
@@ -0,0 +1,76 @@
+/**
+ * @file bench_button.c
+ * @brief Button to state change latency, press to telemetry_state()
+ * @note START is pressed at a different phase of the scan timer each
+ *       time. The debouncer needs 4 equal samples, so latency is between
+ *       3 and 4 scan periods plus the processing. Every press must give
+ *       exactly one transition (RUNNING and PAUSED in turn).
+ */
+
+#include <stdio.h>
+#include "bench.h"
+#include "input.h"
+
+#define PRESSES             20
+#define FIRST_PRESS_MS      300
+#define PRESS_EVERY_US      400370  // Walks the press through the scan phase
+#define HOLD_MS             150
+
+#define MAX_TRANSITIONS     (2 * PRESSES)
+
+void __real_telemetry_state(uint8_t channel, uint8_t state);
+
+static uint64_t transitions[MAX_TRANSITIONS];
+static uint32_t transition_count;
+
+// Linked with --wrap, called by the state machine on every transition
+void __wrap_telemetry_state(uint8_t channel, uint8_t state) {
+    if(transition_count < MAX_TRANSITIONS) {
+        transitions[transition_count] = mock_cycles();
+    }
+    transition_count++;
+    __real_telemetry_state(channel, state);
+}
+
+static void start_button(void *arg) {
+    mock_pin_input(1, 22, !arg);    // Active low
+}
+
+int main(void) {
+    uint64_t pressed[PRESSES];
+    bench_stat_t latency = { 0 };
+    uint32_t t = 0, extra = 0, missed = 0;
+    bool ok = true;
+
+    bench_reset();
+    bench_console_at(100, "set 10:00");     // No expiry during the run
+    for(uint32_t i = 0; i < PRESSES; i++) {
+        pressed[i] = BENCH_MS(FIRST_PRESS_MS) + BENCH_US((uint64_t)PRESS_EVERY_US * i);
+        mock_at(pressed[i], start_button, (void *)1);
+        mock_at(pressed[i] + BENCH_MS(HOLD_MS), start_button, 0);
+    }
+    bench_run(FIRST_PRESS_MS + PRESSES * PRESS_EVERY_US / 1000 + 100);
+
+    // Transitions before the first press are from the console
+    while(t < transition_count && t < MAX_TRANSITIONS && transitions[t] < pressed[0]) t++;
+    for(uint32_t i = 0; i < PRESSES; i++) {
+        uint64_t next = (i + 1 < PRESSES) ? pressed[i + 1] : UINT64_MAX;
+        uint32_t n = 0;
+
+        for(; t < transition_count && t < MAX_TRANSITIONS && transitions[t] < next; t++) {
+            if(n++ == 0) {
+                bench_stat_add(&latency, transitions[t] - pressed[i]);
+            }
+        }
+        if(n == 0) missed++;
+        if(n > 1) extra += n - 1;
+    }
+
+    printf("button latency: scan %u ms, %u presses\n", INPUT_SCAN_MS, PRESSES);
+    bench_stat_print("press to transition", &latency);
+    ok &= bench_check("missed presses", missed, 0, true);
+    ok &= bench_check("extra transitions", extra, 0, true);
+    ok &= bench_check("min latency ms", latency.min / (BENCH_CPU_HZ / 1e3), 3 * INPUT_SCAN_MS, false);
+    ok &= bench_check("max latency ms", latency.max / (BENCH_CPU_HZ / 1e3), 4 * INPUT_SCAN_MS + 1, true);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file bench_display.c
+ * @brief Display refresh latency and jitter, with the main loop under load
+ * @note Every PWM1 MR5 match must have loaded the next digit's segments
+ *       and latched its duty before the next period starts, the window
+ *       DISPLAY_DUTY_MAX leaves free. The console and a running countdown
+ *       keep the main loop and the UART interrupt busy meanwhile.
+ */
+
+#include <stdio.h>
+#include "bench.h"
+#include "display.h"
+#include "pwm.h"
+
+#define RUN_MS              2000
+#define REFRESH_MATCH       5       // display_direct.c
+#define PERIOD_CYCLES       (BENCH_CPU_HZ / (DISPLAY_REFRESH_HZ * DISPLAY_DIGITS))
+#define DEADLINE_CYCLES     (PERIOD_CYCLES * (PWM_DUTY_MAX - DISPLAY_DUTY_MAX) / PWM_DUTY_MAX)
+
+#define SEG_PIN_ADDR        MOCK_FIO_ADDR(0, 0x14)    // FIO0PIN
+#define PWM1_EXC            MOCK_EXC_IRQ(PWM1_IRQn)
+
+static void press(void *arg) {
+    mock_pin_input(1, 22, !arg);    // START, active low
+}
+
+int main(void) {
+    bench_stat_t to_segments = { 0 }, to_done = { 0 }, interval = { 0 };
+    uint64_t match = 0, last_write = 0;
+    bool ok = true;
+
+    bench_reset();
+    bench_console_at(100, "set 10:00");
+    mock_at(BENCH_MS(300), press, (void *)1);
+    mock_at(BENCH_MS(450), press, 0);
+    for(uint32_t ms = 500; ms < RUN_MS; ms += 100) {
+        bench_console_at(ms, (ms / 100) % 2 ? "stats" : "help");
+    }
+    bench_run(RUN_MS);
+
+    for(size_t i = 0; i < mock_log_count(); i++) {
+        const mock_event_t *e = mock_log(i);
+
+        if(e->kind == MOCK_EV_MATCH && e->value == REFRESH_MATCH) {
+            match = e->cycle;
+        } else if(match && e->kind == MOCK_EV_WRITE && e->addr == SEG_PIN_ADDR) {
+            bench_stat_add(&to_segments, e->cycle - match);
+            if(last_write) {
+                uint64_t d = e->cycle - last_write;
+                bench_stat_add(&interval, d > PERIOD_CYCLES ? d - PERIOD_CYCLES : PERIOD_CYCLES - d);
+            }
+            last_write = e->cycle;
+        } else if(match && e->kind == MOCK_EV_IRQ_EXIT && e->addr == PWM1_EXC) {
+            bench_stat_add(&to_done, e->cycle - match);
+            match = 0;
+        }
+    }
+
+    printf("display refresh: %u Hz per digit, period %lu us, deadline %lu us after MR%u\n",
+           DISPLAY_REFRESH_HZ, PERIOD_CYCLES / (BENCH_CPU_HZ / 1000000),
+           DEADLINE_CYCLES / (BENCH_CPU_HZ / 1000000), REFRESH_MATCH);
+    bench_stat_print("match to segments", &to_segments);
+    bench_stat_print("match to handler exit", &to_done);
+    bench_stat_print("interval error", &interval);
+    printf("%-28s %u, %.1f us per call\n", "PWM1 interrupts", (unsigned)mock_irq_count(PWM1_EXC),
+           mock_irq_count(PWM1_EXC) ? mock_irq_cycles(PWM1_EXC) / (BENCH_CPU_HZ / 1e6) / mock_irq_count(PWM1_EXC) : 0);
+
+    // Every period refreshed, each one finished before the next digit lights
+    ok &= bench_check("refreshes", to_done.count, RUN_MS * DISPLAY_REFRESH_HZ * DISPLAY_DIGITS / 1000 - 2, false);
+    ok &= bench_check("max handler exit us", to_done.max / (BENCH_CPU_HZ / 1e6),
+                      DEADLINE_CYCLES / (BENCH_CPU_HZ / 1e6), true);
+    ok &= bench_check("segment jitter us", (to_segments.max - to_segments.min) / (BENCH_CPU_HZ / 1e6), 25, true);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file bench_uart.c
+ * @brief Telemetry UART throughput: line use while replies are long
+ * @note Long console replies (help, stats) wait for TX space, so the
+ *       transmitter must not go idle until they're out: the THRE
+ *       interrupt has to refill the FIFO before it drains. Every byte on
+ *       the wire must also decode as a frame with a good CRC.
+ */
+
+#include <stdio.h>
+#include "bench.h"
+#include "telemetry.h"
+#include "frame.h"
+
+#define RUN_MS              1500
+#define BURST_GAP_CHARS     20      // Idle time that ends a burst
+
+#define UART_EXC            MOCK_EXC_IRQ(UART0_IRQn + TELEMETRY_UART)
+
+typedef struct {
+    uint32_t frames;
+    uint32_t bad;               // COBS or CRC errors
+    uint32_t stray;             // Bytes outside any frame
+    uint32_t text;              // TLM_MSG_TEXT frames
+} decode_t;
+
+// CRC-16/CCITT-FALSE, kept apart from frame.c to check it
+static uint16_t crc16(const uint8_t *p, size_t len) {
+    uint16_t crc = 0xFFFF;
+
+    while(len--) {
+        crc ^= (uint16_t)*p++ << 8;
+        for(uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void check_frame(decode_t *d, const uint8_t *in, size_t len) {
+    uint8_t raw[FRAME_ENCODED_MAX];
+    size_t n = 0;
+
+    for(size_t i = 0; i < len;) {
+        uint8_t code = in[i++];
+
+        if(code == 0 || i + code - 1 > len) {
+            d->bad++;
+            return;
+        }
+        for(uint8_t k = 1; k < code; k++) raw[n++] = in[i++];
+        if(code < 0xFF && i < len) raw[n++] = 0;
+    }
+    if(n < 3 || n > FRAME_RAW_MAX || crc16(raw, n - 2) != (raw[n - 2] | raw[n - 1] << 8)) {
+        d->bad++;
+        return;
+    }
+    d->frames++;
+    if(raw[0] == TLM_MSG_TEXT) d->text++;
+}
+
+static decode_t decode(const mock_tx_t *tx, size_t count) {
+    decode_t d = { 0 };
+    uint8_t frame[FRAME_ENCODED_MAX];
+    size_t len = 0;
+    bool open = false;
+
+    for(size_t i = 0; i < count; i++) {
+        if(tx[i].byte == FRAME_DELIMITER) {
+            if(open && len > 0) check_frame(&d, frame, len);
+            open = true;
+            len = 0;
+        } else if(!open) {
+            d.stray++;
+        } else if(len < sizeof(frame)) {
+            frame[len++] = tx[i].byte;
+        } else {
+            d.bad++;
+            open = false;
+        }
+    }
+    return d;
+}
+
+int main(void) {
+    const mock_tx_t *tx;
+    size_t count;
+    uint64_t busy = 0, bytes = 0, gap_max = 0, char_cycles;
+    bool ok = true;
+
+    bench_reset();
+    bench_console_at(100, "help");
+    bench_console_at(400, "stats");
+    bench_console_at(600, "help");
+    bench_console_at(900, "show");
+    bench_console_at(1000, "stats");
+    bench_console_at(1100, "help");
+    bench_run(RUN_MS);
+
+    tx = mock_uart_tx(TELEMETRY_UART, &count);
+    if(count == 0) {
+        printf("uart throughput: nothing sent\n");
+        return 1;
+    }
+    char_cycles = tx[0].end - tx[0].start;
+
+    // Line use within bursts: character times over the time they span
+    for(size_t i = 0, first = 0; i < count; i++) {
+        bool last = (i + 1 == count) || tx[i + 1].start - tx[i].end > BURST_GAP_CHARS * char_cycles;
+
+        if(i > first) {
+            uint64_t gap = tx[i].start - tx[i - 1].end;
+            if(gap > gap_max) gap_max = gap;
+        }
+        if(last) {
+            if(i > first) {
+                busy += tx[i].end - tx[first].start;
+                bytes += i - first + 1;
+            }
+            first = i + 1;
+        }
+    }
+
+    decode_t d = decode(tx, count);
+    double use = busy ? 100.0 * bytes * char_cycles / busy : 0;
+    double gap_chars = (double)gap_max / char_cycles;
+    double isr_per_byte = (double)mock_irq_cycles(UART_EXC) / count;
+
+    printf("uart throughput: %u baud, %.1f us per character, %zu bytes sent\n",
+           TELEMETRY_BAUD, char_cycles / (BENCH_CPU_HZ / 1e6), count);
+    printf("%-28s %u (%u text), %u bad, %u stray bytes\n", "frames",
+           (unsigned)d.frames, (unsigned)d.text, (unsigned)d.bad, (unsigned)d.stray);
+    printf("%-28s %u calls, %.1f cycles per byte\n", "UART interrupt",
+           (unsigned)mock_irq_count(UART_EXC), isr_per_byte);
+
+    ok &= bench_check("bad frames", d.bad + d.stray, 0, true);
+    ok &= bench_check("text frames", d.text, 20, false);
+    ok &= bench_check("line use in bursts %", use, 95, false);
+    ok &= bench_check("longest gap in burst chars", gap_chars, 1, true);
+    ok &= bench_check("dropped RX bytes", mock_uart_overruns(TELEMETRY_UART), 0, true);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file lpc17xx.h
+ * @brief Host stand-in for the CMSIS LPC17xx header: registers in RAM
+ * @note Same register layouts as the CMSIS header, but every peripheral
+ *       lives in mock_regs, a plain RAM struct the mock watches (see
+ *       mock.h). The core intrinsics and the NVIC functions are mock
+ *       functions, so masking, pending and WFI follow the virtual clock.
+ */
+
+#ifndef LPC17XX_H
+#define LPC17XX_H
+
+#include <stdint.h>
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+
+/* ==================== Interrupt Numbers ==================== */
+typedef enum {
+    SysTick_IRQn = -1,
+    WDT_IRQn     = 0,
+    TIMER0_IRQn, TIMER1_IRQn, TIMER2_IRQn, TIMER3_IRQn,
+    UART0_IRQn, UART1_IRQn, UART2_IRQn, UART3_IRQn,
+    PWM1_IRQn, I2C0_IRQn, I2C1_IRQn, I2C2_IRQn, SPI_IRQn,
+    SSP0_IRQn, SSP1_IRQn, PLL0_IRQn, RTC_IRQn,
+    EINT0_IRQn, EINT1_IRQn, EINT2_IRQn, EINT3_IRQn,
+    ADC_IRQn, BOD_IRQn, USB_IRQn, CAN_IRQn, DMA_IRQn,
+    I2S_IRQn, ENET_IRQn, RIT_IRQn, MCPWM_IRQn, QEI_IRQn,
+    PLL1_IRQn, USBActivity_IRQn, CANActivity_IRQn,
+    MOCK_IRQ_COUNT
+} IRQn_Type;
+
+/* ==================== Register Blocks ==================== */
+typedef struct {
+    __IO uint32_t FLASHCFG;         // 0x000
+    uint32_t RESERVED0[31];
+    __IO uint32_t PLL0CON;          // 0x080
+    __IO uint32_t PLL0CFG;
+    __I  uint32_t PLL0STAT;
+    __O  uint32_t PLL0FEED;
+    uint32_t RESERVED1[4];
+    __IO uint32_t PLL1CON;          // 0x0A0
+    __IO uint32_t PLL1CFG;
+    __I  uint32_t PLL1STAT;
+    __O  uint32_t PLL1FEED;
+    uint32_t RESERVED2[4];
+    __IO uint32_t PCON;             // 0x0C0
+    __IO uint32_t PCONP;
+    uint32_t RESERVED3[15];
+    __IO uint32_t CCLKCFG;          // 0x104
+    __IO uint32_t USBCLKCFG;
+    __IO uint32_t CLKSRCSEL;
+    __IO uint32_t CANSLEEPCLR;
+    __IO uint32_t CANWAKEFLAGS;
+    uint32_t RESERVED4[10];
+    __IO uint32_t EXTINT;           // 0x140
+    uint32_t RESERVED5;
+    __IO uint32_t EXTMODE;
+    __IO uint32_t EXTPOLAR;
+    uint32_t RESERVED6[12];
+    __IO uint32_t RSID;             // 0x180
+    uint32_t RESERVED7[7];
+    __IO uint32_t SCS;              // 0x1A0
+    __IO uint32_t IRCTRIM;
+    __IO uint32_t PCLKSEL0;
+    __IO uint32_t PCLKSEL1;
+    uint32_t RESERVED8[4];
+    __IO uint32_t USBIntSt;         // 0x1C0
+    __IO uint32_t DMAREQSEL;
+    __IO uint32_t CLKOUTCFG;
+} LPC_SC_TypeDef;
+
+typedef struct {
+    __IO uint32_t IR, TCR, TC, PR, PC, MCR, MR0, MR1, MR2, MR3, CCR;
+    __I  uint32_t CR0, CR1;
+    uint32_t RESERVED0[2];
+    __IO uint32_t EMR;              // 0x03C
+    uint32_t RESERVED1[12];
+    __IO uint32_t CTCR;             // 0x070
+} LPC_TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t IR, TCR, TC, PR, PC, MCR, MR0, MR1, MR2, MR3, CCR;
+    __I  uint32_t CR0, CR1, CR2, CR3;
+    uint32_t RESERVED0;
+    __IO uint32_t MR4, MR5, MR6;    // 0x040
+    __IO uint32_t PCR, LER;
+    uint32_t RESERVED1[7];
+    __IO uint32_t CTCR;             // 0x070
+} LPC_PWM_TypeDef;
+
+// RBR/THR/DLL, DLM/IER and IIR/FCR share their addresses
+typedef struct {
+    __IO uint32_t RBR;              // 0x00 RBR/THR/DLL
+    __IO uint32_t IER;              // 0x04 DLM/IER
+    __IO uint32_t IIR;              // 0x08 IIR/FCR
+    __IO uint32_t LCR, MCR, LSR, MSR, SCR, ACR, ICR, FDR;
+    uint32_t RESERVED0;
+    __IO uint32_t TER;              // 0x30
+} LPC_UART_TypeDef;
+
+typedef struct {
+    __I  uint32_t IntStatus;        // 0x080
+    __I  uint32_t IO0IntStatR, IO0IntStatF;
+    __O  uint32_t IO0IntClr;
+    __IO uint32_t IO0IntEnR, IO0IntEnF;
+    uint32_t RESERVED0[3];
+    __I  uint32_t IO2IntStatR, IO2IntStatF;
+    __O  uint32_t IO2IntClr;
+    __IO uint32_t IO2IntEnR, IO2IntEnF;
+} LPC_GPIOINT_TypeDef;
+
+typedef struct {
+    __IO uint32_t ILR;
+    uint32_t RESERVED0;
+    __IO uint32_t CCR, CIIR, AMR;
+    __I  uint32_t CTIME0, CTIME1, CTIME2;
+    __IO uint32_t SEC, MIN, HOUR, DOM, DOW, DOY, MONTH, YEAR;
+    __IO uint32_t CALIBRATION;
+    __IO uint32_t GPREG0, GPREG1, GPREG2, GPREG3, GPREG4;
+    __IO uint32_t RTC_AUXEN, RTC_AUX;
+    __IO uint32_t ALSEC, ALMIN, ALHOUR, ALDOM, ALDOW, ALDOY, ALMON, ALYEAR;
+} LPC_RTC_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR0, CR1, DR;
+    __I  uint32_t SR;
+    __IO uint32_t CPSR, IMSC, RIS, MIS, ICR, DMACR;
+} LPC_SSP_TypeDef;
+
+typedef struct {
+    __I  uint32_t DMACIntStat, DMACIntTCStat;
+    __O  uint32_t DMACIntTCClear;
+    __I  uint32_t DMACIntErrStat;
+    __O  uint32_t DMACIntErrClr;
+    __I  uint32_t DMACRawIntTCStat, DMACRawIntErrStat, DMACEnbldChns;
+    __IO uint32_t DMACSoftBReq, DMACSoftSReq, DMACSoftLBReq, DMACSoftLSReq;
+    __IO uint32_t DMACConfig, DMACSync;
+} LPC_GPDMA_TypeDef;
+
+typedef struct {
+    __IO uint32_t DMACCSrcAddr, DMACCDestAddr, DMACCLLI, DMACCControl, DMACCConfig;
+    uint32_t RESERVED0[3];          // Channels are 0x20 apart
+} LPC_GPDMACH_TypeDef;
+
+typedef struct {
+    __I  uint32_t CPUID;
+    __IO uint32_t ICSR, VTOR, AIRCR, SCR, CCR;
+    __IO uint8_t  SHP[12];
+    __IO uint32_t SHCSR, CFSR, HFSR, DFSR, MMFAR, BFAR, AFSR;
+} SCB_Type;
+
+typedef struct {
+    __IO uint32_t DHCSR;
+    __O  uint32_t DCRSR;
+    __IO uint32_t DCRDR, DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+    __IO uint32_t CTRL, CYCCNT;
+} DWT_Type;
+
+#define SCB_SCR_SLEEPONEXIT_Msk (1UL << 1)
+#define SCB_SCR_SLEEPDEEP_Msk   (1UL << 2)
+
+/* ==================== Register RAM ==================== */
+#define MOCK_BITBAND_SLOTS  64      // Distinct (word, bit) aliases in use
+
+// Every peripheral register of the firmware, word for word. In log
+// entries the mock reports the real LPC17xx address of each one.
+typedef struct {
+    LPC_SC_TypeDef      sc;         // 0x400FC000
+    __IO uint32_t       pincon[32]; // 0x4002C000 PINSEL0-10, PINMODE0-9 at +0x40
+    __IO uint32_t       fio[5 * 8]; // 0x2009C000 FIODIR, -, -, -, FIOMASK, FIOPIN, FIOSET, FIOCLR
+    LPC_GPIOINT_TypeDef gpioint;    // 0x40028080
+    LPC_UART_TypeDef    uart[4];    // 0x4000C000, 0x40010000, 0x40098000, 0x4009C000
+    LPC_TIM_TypeDef     tim[4];     // 0x40004000, 0x40008000, 0x40090000, 0x40094000
+    LPC_PWM_TypeDef     pwm1;       // 0x40018000
+    LPC_RTC_TypeDef     rtc;        // 0x40024000
+    LPC_SSP_TypeDef     ssp[2];     // 0x40088000, 0x40030000
+    LPC_GPDMA_TypeDef   gpdma;      // 0x50004000
+    LPC_GPDMACH_TypeDef gpdmach[8]; // 0x50004100
+    __IO uint32_t       systick[4]; // 0xE000E010 CTRL, LOAD, VAL, CALIB
+    SCB_Type            scb;        // 0xE000ED00
+    CoreDebug_Type      coredebug;  // 0xE000EDF0
+    DWT_Type            dwt;        // 0xE0001000
+    __IO uint32_t       bitband[MOCK_BITBAND_SLOTS];  // Alias words, see mock_bitband()
+} mock_regs_t;
+
+extern mock_regs_t mock_regs;
+
+#define LPC_SC          (&mock_regs.sc)
+#define LPC_GPIOINT     (&mock_regs.gpioint)
+#define LPC_UART0       (&mock_regs.uart[0])
+#define LPC_UART1       (&mock_regs.uart[1])
+#define LPC_UART2       (&mock_regs.uart[2])
+#define LPC_UART3       (&mock_regs.uart[3])
+#define LPC_TIM0        (&mock_regs.tim[0])
+#define LPC_TIM1        (&mock_regs.tim[1])
+#define LPC_TIM2        (&mock_regs.tim[2])
+#define LPC_TIM3        (&mock_regs.tim[3])
+#define LPC_PWM1        (&mock_regs.pwm1)
+#define LPC_RTC         (&mock_regs.rtc)
+#define LPC_SSP0        (&mock_regs.ssp[0])
+#define LPC_SSP1        (&mock_regs.ssp[1])
+#define LPC_GPDMA       (&mock_regs.gpdma)
+#define LPC_GPDMACH0    (&mock_regs.gpdmach[0])
+#define LPC_GPDMACH1    (&mock_regs.gpdmach[1])
+#define LPC_GPDMACH2    (&mock_regs.gpdmach[2])
+#define LPC_GPDMACH3    (&mock_regs.gpdmach[3])
+#define LPC_GPDMACH4    (&mock_regs.gpdmach[4])
+#define LPC_GPDMACH5    (&mock_regs.gpdmach[5])
+#define LPC_GPDMACH6    (&mock_regs.gpdmach[6])
+#define LPC_GPDMACH7    (&mock_regs.gpdmach[7])
+#define SCB             (&mock_regs.scb)
+#define CoreDebug       (&mock_regs.coredebug)
+#define DWT             (&mock_regs.dwt)
+
+// LPC_GPIO_TypeDef is the firmware's own (gpio.c)
+#define LPC_GPIO0       ((LPC_GPIO_TypeDef *)&mock_regs.fio[0])
+#define LPC_GPIO1       ((LPC_GPIO_TypeDef *)&mock_regs.fio[8])
+#define LPC_GPIO2       ((LPC_GPIO_TypeDef *)&mock_regs.fio[16])
+#define LPC_GPIO3       ((LPC_GPIO_TypeDef *)&mock_regs.fio[24])
+#define LPC_GPIO4       ((LPC_GPIO_TypeDef *)&mock_regs.fio[32])
+
+#define PINSEL0         (mock_regs.pincon[0])
+#define PINSEL1         (mock_regs.pincon[1])
+#define PINSEL2         (mock_regs.pincon[2])
+#define PINSEL3         (mock_regs.pincon[3])
+#define PINSEL4         (mock_regs.pincon[4])
+#define PINSEL7         (mock_regs.pincon[7])
+#define PINSEL9         (mock_regs.pincon[9])
+#define PINSEL10        (mock_regs.pincon[10])
+#define PINMODE0        (mock_regs.pincon[16])
+#define PINMODE1        (mock_regs.pincon[17])
+#define PINMODE2        (mock_regs.pincon[18])
+#define PINMODE3        (mock_regs.pincon[19])
+#define PINMODE4        (mock_regs.pincon[20])
+#define PINMODE7        (mock_regs.pincon[23])
+#define PINMODE9        (mock_regs.pincon[25])
+
+/* ==================== Core Functions ==================== */
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+uint32_t __get_IPSR(void);
+uint32_t __get_MSP(void);
+void __WFI(void);
+
+uint32_t __LDREXW(volatile uint32_t *addr);
+uint32_t __STREXW(uint32_t value, volatile uint32_t *addr);
+void __CLREX(void);
+
+static inline void __NOP(void) { }
+static inline void __DSB(void) { __asm__ volatile("" ::: "memory"); }
+static inline void __DMB(void) { __asm__ volatile("" ::: "memory"); }
+static inline void __ISB(void) { __asm__ volatile("" ::: "memory"); }
+static inline uint8_t __CLZ(uint32_t value) { return value ? (uint8_t)__builtin_clz(value) : 32; }
+
+static inline uint32_t __RBIT(uint32_t value) {
+    uint32_t out = 0;
+
+    for(uint8_t i = 0; i < 32; i++, value >>= 1) {
+        out = (out << 1) | (value & 1);
+    }
+    return out;
+}
+
+#endif // LPC17XX_H
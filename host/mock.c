@@ -0,0 +1,1463 @@
+/**
+ * @file mock.c
+ * @brief Register mock implementation: access hooks, NVIC, peripheral
+ *        models and the fake boot ROM
+ */
+
+#include "mock.h"
+#include <lpc17xx.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* ==================== Register and Stack RAM ==================== */
+mock_regs_t mock_regs;
+
+#define MOCK_STACK_WORDS    1024    // Painted by diag_init(), never the real stack
+uint32_t mock_stack_limit[MOCK_STACK_WORDS];
+__asm__(".globl mock_stack_top\n.set mock_stack_top, mock_stack_limit + 4 * 1024");
+
+#define NEVER               UINT64_MAX
+#define EXC_COUNT           (16 + MOCK_IRQ_COUNT)
+#define EXC_BIT(e)          (1ULL << (e))
+#define THREAD_PRIO         256
+#define IRQ_ENTRY_CYCLES    12      // Stacking
+#define IRQ_EXIT_CYCLES     10      // Unstacking
+
+#define IRC_HZ              4000000UL
+#define MAIN_OSC_HZ         12000000UL
+#define RTC_OSC_HZ          32768UL
+
+/* ==================== Clock and Run State ==================== */
+static uint64_t now;                // Virtual CPU cycles since reset
+static uint64_t next_event = NEVER; // Earliest hardware event or run end
+static uint64_t hw_time;            // Models are up to date until here
+static bool in_stimulus;            // A mock_at() callback runs, at hw_time
+static uint64_t run_end = NEVER;
+static bool in_run;
+static jmp_buf run_jmp;
+
+// Register write waiting for the store to land (next hook commits it)
+static bool write_pending;
+static uintptr_t write_addr;
+static uint64_t write_cycle;
+
+// RAM store to a watched range, logged with its value at the next hook
+static uintptr_t watch_addr;
+static uint64_t watch_cycle;
+static struct {
+    uintptr_t start, size;
+} watches[MOCK_WATCHES];
+static uint8_t watch_count;
+
+static struct {
+    uint64_t at;
+    void (*fn)(void *arg);
+    void *arg;
+} timers[MOCK_TIMERS];
+static uint8_t timer_count;
+
+/* ==================== NVIC State ==================== */
+static uint64_t pending;            // Bit per exception number
+static uint64_t enabled;
+static uint64_t active;             // Handlers on the (virtual) stack
+static uint8_t prio[EXC_COUNT];
+static int cur_exc;                 // IPSR, 0 in thread mode
+static int cur_prio = THREAD_PRIO;
+static bool primask;
+static bool exclusive;              // LDREX monitor, cleared by exceptions
+static uint32_t taken;              // Handlers run, so __WFI() sees a wake it slept through
+static uint64_t irq_cycles[EXC_COUNT];
+static uint32_t irq_count[EXC_COUNT];
+
+#define HANDLER(name) extern void name(void) __attribute__((weak));
+HANDLER(SysTick_Handler)
+HANDLER(TIMER0_IRQHandler) HANDLER(TIMER1_IRQHandler)
+HANDLER(TIMER2_IRQHandler) HANDLER(TIMER3_IRQHandler)
+HANDLER(UART0_IRQHandler) HANDLER(UART1_IRQHandler)
+HANDLER(UART2_IRQHandler) HANDLER(UART3_IRQHandler)
+HANDLER(PWM1_IRQHandler) HANDLER(SSP0_IRQHandler) HANDLER(SSP1_IRQHandler)
+HANDLER(RTC_IRQHandler) HANDLER(EINT3_IRQHandler) HANDLER(DMA_IRQHandler)
+
+static void (*handler_of(int exc))(void) {
+    switch(exc) {
+        case MOCK_EXC_SYSTICK:              return SysTick_Handler;
+        case MOCK_EXC_IRQ(TIMER0_IRQn):     return TIMER0_IRQHandler;
+        case MOCK_EXC_IRQ(TIMER1_IRQn):     return TIMER1_IRQHandler;
+        case MOCK_EXC_IRQ(TIMER2_IRQn):     return TIMER2_IRQHandler;
+        case MOCK_EXC_IRQ(TIMER3_IRQn):     return TIMER3_IRQHandler;
+        case MOCK_EXC_IRQ(UART0_IRQn):      return UART0_IRQHandler;
+        case MOCK_EXC_IRQ(UART1_IRQn):      return UART1_IRQHandler;
+        case MOCK_EXC_IRQ(UART2_IRQn):      return UART2_IRQHandler;
+        case MOCK_EXC_IRQ(UART3_IRQn):      return UART3_IRQHandler;
+        case MOCK_EXC_IRQ(PWM1_IRQn):       return PWM1_IRQHandler;
+        case MOCK_EXC_IRQ(SSP0_IRQn):       return SSP0_IRQHandler;
+        case MOCK_EXC_IRQ(SSP1_IRQn):       return SSP1_IRQHandler;
+        case MOCK_EXC_IRQ(RTC_IRQn):        return RTC_IRQHandler;
+        case MOCK_EXC_IRQ(EINT3_IRQn):      return EINT3_IRQHandler;
+        case MOCK_EXC_IRQ(DMA_IRQn):        return DMA_IRQHandler;
+        default:                            return 0;
+    }
+}
+
+/* ==================== Peripheral State ==================== */
+static struct {
+    uint32_t pll0con;               // Fed values, PLL0CON/CFG RAM holds the written ones
+    uint32_t pll0cfg;
+    bool feed_aa;
+} sc;
+
+static struct {
+    uint32_t latch[5];              // Output register
+    uint32_t input[5];              // External pin levels
+} gpio;
+
+static struct {
+    uintptr_t target;               // Register word in mock_regs
+    uint8_t bit;
+} bitband[MOCK_BITBAND_SLOTS];
+static uint8_t bitband_count;
+
+static struct {
+    uint32_t val;                   // VAL at time t
+    uint64_t t;
+    uint32_t load;
+    bool enabled;
+    bool tickint;
+    bool countflag;
+} systick;
+
+static struct {
+    uint32_t base;
+    uint8_t clock;                  // clock_periph_t of its PCLKSEL field
+    uint8_t tx_fifo[16];
+    uint8_t tx_head, tx_count;
+    bool tx_busy;                   // Shift register in use
+    uint8_t tx_shift;
+    uint64_t tx_start, tx_done;
+    uint8_t rx_fifo[16];
+    uint8_t rx_head, rx_count;
+    uint8_t rx_queue[MOCK_RX_QUEUE];
+    size_t rxq_head, rxq_count;
+    uint64_t rx_next;               // Arrival of rx_queue[rxq_head]
+    uint64_t rx_last;               // Last arrival or RBR read (timeout)
+    uint8_t rx_trigger;
+    uint8_t dll, dlm, ier;
+    bool thre_int;
+    bool overrun;
+    uint32_t overruns;
+    mock_tx_t tx_log[MOCK_TX_CAPTURE];
+    size_t tx_logged;
+} uart[4];
+
+static const uint32_t uart_bases[4] = { 0x4000C000, 0x40010000, 0x40098000, 0x4009C000 };
+static const uint8_t uart_clocks[4] = { 3, 4, 24, 25 };
+
+static struct {
+    uint32_t tc;
+    uint64_t t;                     // Time of the last TC tick counted
+    uint32_t active[7];             // Match values in use (MRn RAM is the shadow)
+    uint32_t ir;
+    bool running;
+} pwm;
+
+static const uint8_t pwm_ir_bit[7] = { 0, 1, 2, 3, 8, 9, 10 };
+
+static struct {
+    bool running;
+    uint64_t next_sec;
+    uint32_t ilr;
+} rtc;
+
+static struct {
+    bool on;
+    uint64_t base;                  // now - CYCCNT while counting
+    uint32_t frozen;
+} dwt;
+
+/* ==================== Event Log ==================== */
+static mock_event_t log_buf[MOCK_LOG_SIZE];
+static size_t log_total;
+
+static void log_event(uint64_t cycle, mock_kind_t kind, uint32_t addr, uint32_t value) {
+    mock_event_t *e = &log_buf[log_total++ % MOCK_LOG_SIZE];
+
+    e->cycle = cycle;
+    e->kind = kind;
+    e->addr = addr;
+    e->value = value;
+}
+
+/* ==================== Fake Flash and Boot ROM ==================== */
+#define IAP_SECTOR_FIRST    28
+#define IAP_SECTOR_SIZE     0x8000UL
+
+static uint8_t *flash;
+static uint32_t prepared;           // Sector bits, consumed by copy/erase
+static uint32_t iap_count[64];
+static uint32_t tear_writes = UINT32_MAX;
+static uint32_t tear_bytes;
+
+/* ==================== Register Map ==================== */
+typedef struct {
+    size_t off, size;
+    uint32_t base;
+} region_t;
+
+#define REGION(member, base) { offsetof(mock_regs_t, member), sizeof(mock_regs.member), base }
+
+static const region_t regions[] = {
+    REGION(sc, 0x400FC000), REGION(pincon, 0x4002C000), REGION(fio, 0x2009C000),
+    REGION(gpioint, 0x40028080),
+    REGION(uart[0], 0x4000C000), REGION(uart[1], 0x40010000),
+    REGION(uart[2], 0x40098000), REGION(uart[3], 0x4009C000),
+    REGION(tim[0], 0x40004000), REGION(tim[1], 0x40008000),
+    REGION(tim[2], 0x40090000), REGION(tim[3], 0x40094000),
+    REGION(pwm1, 0x40018000), REGION(rtc, 0x40024000),
+    REGION(ssp[0], 0x40088000), REGION(ssp[1], 0x40030000),
+    REGION(gpdma, 0x50004000), REGION(gpdmach, 0x50004100),
+    REGION(systick, 0xE000E010), REGION(scb, 0xE000ED00),
+    REGION(coredebug, 0xE000EDF0), REGION(dwt, 0xE0001000),
+};
+
+#define REG_OFF(a)          ((uintptr_t)(a) - (uintptr_t)&mock_regs)
+#define IS_REG(a)           (REG_OFF(a) < sizeof(mock_regs))
+#define IN(a, member)       (REG_OFF(a) - offsetof(mock_regs_t, member) < sizeof(mock_regs.member))
+#define OFF_IN(a, member)   (REG_OFF(a) - offsetof(mock_regs_t, member))
+#define RAM(a)              (*(volatile uint32_t *)(a))
+
+static uint32_t real_addr(uintptr_t a) {
+    size_t off = REG_OFF(a);
+
+    for(size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        if(off - regions[i].off < regions[i].size) {
+            return regions[i].base + (uint32_t)(off - regions[i].off);
+        }
+    }
+    return 0;
+}
+
+/* ==================== Clocks ==================== */
+
+uint32_t mock_cpu_hz(void) {
+    uint32_t src;
+
+    switch(mock_regs.sc.CLKSRCSEL & 3) {
+        case 1:  src = MAIN_OSC_HZ; break;
+        case 2:  src = RTC_OSC_HZ; break;
+        default: src = IRC_HZ; break;
+    }
+    if((sc.pll0con & 3) == 3) {
+        uint32_t m = (sc.pll0cfg & 0x7FFF) + 1;
+        uint32_t n = ((sc.pll0cfg >> 16) & 0xFF) + 1;
+        src = (uint32_t)((2ULL * m * src) / n);
+    }
+    return src / ((mock_regs.sc.CCLKCFG & 0xFF) + 1);
+}
+
+// CCLK cycles per PCLK cycle of a peripheral
+static uint32_t pclk_div(uint8_t periph) {
+    static const uint8_t div[4] = { 4, 1, 2, 8 };
+    uint32_t reg = (periph < 16) ? mock_regs.sc.PCLKSEL0 : mock_regs.sc.PCLKSEL1;
+
+    return div[(reg >> ((periph % 16) * 2)) & 3];
+}
+
+uint64_t mock_cycles(void) {
+    return now;
+}
+
+uint64_t mock_ms(uint32_t ms) {
+    return (uint64_t)mock_cpu_hz() * ms / 1000;
+}
+
+uint64_t mock_us(uint32_t us) {
+    return (uint64_t)mock_cpu_hz() * us / 1000000;
+}
+
+/* ==================== SysTick Model ==================== */
+
+static void systick_update(uint64_t to) {
+    uint64_t n = to - systick.t;
+
+    systick.t = to;
+    if(!systick.enabled || n == 0) {
+        return;
+    }
+    if(systick.val == 0) {
+        systick.val = systick.load;             // First clock reloads, no event
+        n--;
+        if(systick.val == 0) {
+            return;
+        }
+    }
+    if(n < systick.val) {
+        systick.val -= (uint32_t)n;
+        return;
+    }
+
+    // Reached zero at least once
+    n -= systick.val;
+    uint64_t r = n % ((uint64_t)systick.load + 1);
+    systick.val = (r == 0 || systick.load == 0) ? 0 : systick.load - (uint32_t)(r - 1);
+    systick.countflag = true;
+    if(systick.tickint) {
+        pending |= EXC_BIT(MOCK_EXC_SYSTICK);
+    }
+}
+
+static uint64_t systick_next(void) {
+    if(!systick.enabled) {
+        return NEVER;
+    }
+    if(systick.val > 0) {
+        return systick.t + systick.val;
+    }
+    return systick.load ? systick.t + 1 + systick.load : NEVER;
+}
+
+/* ==================== PWM1 Model ==================== */
+
+static uint64_t pwm_tick(void) {
+    return (uint64_t)pclk_div(6) * (mock_regs.pwm1.PR + 1);
+}
+
+// TC value that starts the next period: one past MR0, or the 32-bit wrap
+static uint64_t pwm_wrap(void) {
+    uint64_t wrap = (mock_regs.pwm1.MCR & 2) ? (uint64_t)pwm.active[0] + 1 : 0x100000000ULL;
+
+    return (wrap > pwm.tc) ? wrap : 0x100000000ULL;
+}
+
+// Next TC value with something to do
+static uint64_t pwm_target(void) {
+    uint32_t mcr = mock_regs.pwm1.MCR;
+    uint64_t target = pwm_wrap();
+
+    for(uint8_t n = 0; n < 7; n++) {
+        if((mcr & (1UL << (n * 3))) && pwm.active[n] > pwm.tc && pwm.active[n] < target) {
+            target = pwm.active[n];
+        }
+    }
+    return target;
+}
+
+static void pwm_latch(void) {
+    uint32_t ler = mock_regs.pwm1.LER;
+    const volatile uint32_t *mr[7] = {
+        &mock_regs.pwm1.MR0, &mock_regs.pwm1.MR1, &mock_regs.pwm1.MR2, &mock_regs.pwm1.MR3,
+        &mock_regs.pwm1.MR4, &mock_regs.pwm1.MR5, &mock_regs.pwm1.MR6
+    };
+
+    for(uint8_t n = 0; n < 7; n++) {
+        if(ler & (1UL << n)) {
+            pwm.active[n] = *mr[n];
+        }
+    }
+    mock_regs.pwm1.LER = 0;
+}
+
+static void pwm_update(uint64_t to) {
+    if(!pwm.running) {
+        pwm.t = to;
+        return;
+    }
+
+    uint64_t tick = pwm_tick();
+    while(1) {
+        uint64_t target = pwm_target();
+        uint64_t at = pwm.t + (target - pwm.tc) * tick;
+
+        if(at > to) {
+            uint64_t ticks = (to - pwm.t) / tick;
+            pwm.tc += (uint32_t)ticks;
+            pwm.t += ticks * tick;
+            return;
+        }
+        pwm.t = at;
+        if(target == pwm_wrap()) {
+            pwm.tc = 0;                         // Period start
+            pwm_latch();
+            continue;
+        }
+        pwm.tc = (uint32_t)target;
+        for(uint8_t n = 0; n < 7; n++) {
+            if((mock_regs.pwm1.MCR & (1UL << (n * 3))) && pwm.active[n] == pwm.tc) {
+                pwm.ir |= 1UL << pwm_ir_bit[n];
+                log_event(at, MOCK_EV_MATCH, MOCK_PWM1_BASE, n);
+            }
+        }
+    }
+}
+
+static uint64_t pwm_next(void) {
+    return pwm.running ? pwm.t + (pwm_target() - pwm.tc) * pwm_tick() : NEVER;
+}
+
+/* ==================== RTC Model ==================== */
+
+static void rtc_second(void) {
+    LPC_RTC_TypeDef *r = &mock_regs.rtc;
+
+    bool minute = ++r->SEC >= 60;
+    if(minute) {
+        r->SEC = 0;
+        if(++r->MIN >= 60) {
+            r->MIN = 0;
+            if(++r->HOUR >= 24) {
+                r->HOUR = 0;
+                r->DOY++;
+                r->DOM++;
+                r->DOW = (r->DOW + 1) % 7;
+            }
+        }
+    }
+    if((r->CIIR & 1) || ((r->CIIR & 2) && minute)) {
+        rtc.ilr |= 1;
+    }
+
+    uint32_t amr = r->AMR & 0xFF;
+    const uint32_t time[8] = { r->SEC, r->MIN, r->HOUR, r->DOM, r->DOW, r->DOY, r->MONTH, r->YEAR };
+    const uint32_t alarm[8] = { r->ALSEC, r->ALMIN, r->ALHOUR, r->ALDOM, r->ALDOW, r->ALDOY, r->ALMON, r->ALYEAR };
+    bool match = (amr != 0xFF);
+    for(uint8_t i = 0; i < 8 && match; i++) {
+        match = (amr & (1UL << i)) || time[i] == alarm[i];
+    }
+    if(match) {
+        rtc.ilr |= 2;
+    }
+}
+
+static void rtc_update(uint64_t to) {
+    while(rtc.running && rtc.next_sec <= to) {
+        rtc_second();
+        rtc.next_sec += mock_cpu_hz();
+    }
+}
+
+static uint64_t rtc_next(void) {
+    return rtc.running ? rtc.next_sec : NEVER;
+}
+
+/* ==================== UART Model ==================== */
+
+static uint64_t uart_char_cycles(uint8_t u) {
+    uint32_t lcr = mock_regs.uart[u].LCR;
+    uint32_t fdr = mock_regs.uart[u].FDR;
+    uint32_t dl = ((uint32_t)uart[u].dlm << 8) | uart[u].dll;
+    uint32_t mul = (fdr >> 4) ? (fdr >> 4) : 1;
+    uint32_t add = fdr & 15;
+    uint32_t bits = 1 + 5 + (lcr & 3) + ((lcr & 8) ? 1 : 0) + ((lcr & 4) ? 2 : 1);
+
+    if(dl == 0) {
+        dl = 0x10000;
+    }
+    return (uint64_t)bits * 16 * dl * (mul + add) * pclk_div(uart[u].clock) / mul;
+}
+
+static bool uart_timeout(uint8_t u) {
+    return uart[u].rx_count > 0 && hw_time >= uart[u].rx_last + 4 * uart_char_cycles(u);
+}
+
+static bool uart_line(uint8_t u) {
+    uint8_t ier = uart[u].ier;
+
+    return ((ier & 1) && (uart[u].rx_count >= uart[u].rx_trigger || uart_timeout(u)))
+        || ((ier & 2) && uart[u].thre_int)
+        || ((ier & 4) && uart[u].overrun);
+}
+
+static void uart_tx_next(uint8_t u, uint64_t at) {
+    if(uart[u].tx_count == 0 || !(mock_regs.uart[u].TER & 0x80)) {
+        uart[u].tx_busy = false;
+        return;
+    }
+    uart[u].tx_shift = uart[u].tx_fifo[uart[u].tx_head];
+    uart[u].tx_head = (uart[u].tx_head + 1) & 15;
+    uart[u].tx_busy = true;
+    uart[u].tx_start = at;
+    uart[u].tx_done = at + uart_char_cycles(u);
+    if(--uart[u].tx_count == 0) {
+        uart[u].thre_int = true;            // FIFO just went empty
+    }
+}
+
+static void uart_update(uint8_t u, uint64_t to) {
+    while(uart[u].tx_busy && uart[u].tx_done <= to) {
+        if(uart[u].tx_logged < MOCK_TX_CAPTURE) {
+            mock_tx_t *c = &uart[u].tx_log[uart[u].tx_logged++];
+            c->start = uart[u].tx_start;
+            c->end = uart[u].tx_done;
+            c->byte = uart[u].tx_shift;
+        }
+        log_event(uart[u].tx_done, MOCK_EV_TX, uart[u].base, uart[u].tx_shift);
+        uart_tx_next(u, uart[u].tx_done);
+    }
+    while(uart[u].rxq_count > 0 && uart[u].rx_next <= to) {
+        if(uart[u].rx_count < 16) {
+            uart[u].rx_fifo[(uart[u].rx_head + uart[u].rx_count++) & 15] = uart[u].rx_queue[uart[u].rxq_head];
+        } else {
+            uart[u].overrun = true;
+            uart[u].overruns++;
+        }
+        uart[u].rx_last = uart[u].rx_next;
+        uart[u].rxq_head = (uart[u].rxq_head + 1) % MOCK_RX_QUEUE;
+        uart[u].rxq_count--;
+        uart[u].rx_next += uart_char_cycles(u);
+    }
+}
+
+static uint64_t uart_next(uint8_t u) {
+    uint64_t next = NEVER;
+
+    if(uart[u].tx_busy) {
+        next = uart[u].tx_done;
+    }
+    if(uart[u].rxq_count > 0 && uart[u].rx_next < next) {
+        next = uart[u].rx_next;
+    }
+    if(uart[u].rx_count > 0 && !uart_timeout(u)) {
+        uint64_t t = uart[u].rx_last + 4 * uart_char_cycles(u);
+        if(t < next) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+/* ==================== Hardware Stepping ==================== */
+
+static void take_interrupts(void);
+static void commit_write(void);
+
+static void models_update(uint64_t to) {
+    if(to < hw_time) {
+        to = hw_time;                           // Stimulus already processed later
+    }
+    hw_time = to;
+    systick_update(to);
+    pwm_update(to);
+    rtc_update(to);
+    for(uint8_t u = 0; u < 4; u++) {
+        uart_update(u, to);
+    }
+}
+
+// Interrupt lines of the modelled peripherals, level-sensitive
+static uint64_t lines(void) {
+    uint64_t l = 0;
+
+    for(uint8_t u = 0; u < 4; u++) {
+        if(uart_line(u)) {
+            l |= EXC_BIT(MOCK_EXC_IRQ(UART0_IRQn + u));
+        }
+    }
+    if(pwm.ir) {
+        l |= EXC_BIT(MOCK_EXC_IRQ(PWM1_IRQn));
+    }
+    if(rtc.ilr & 3) {
+        l |= EXC_BIT(MOCK_EXC_IRQ(RTC_IRQn));
+    }
+    return l;
+}
+
+// Asserted lines pend, except while their handler runs (again on exit)
+static void relevel(void) {
+    pending |= lines() & ~active;
+}
+
+static void schedule(void) {
+    uint64_t next = run_end;
+    uint64_t t;
+
+    if((t = systick_next()) < next) next = t;
+    if((t = pwm_next()) < next) next = t;
+    if((t = rtc_next()) < next) next = t;
+    for(uint8_t u = 0; u < 4; u++) {
+        if((t = uart_next(u)) < next) next = t;
+    }
+    if(timer_count && timers[0].at < next) {
+        next = timers[0].at;
+    }
+    next_event = next;
+}
+
+static void stop_run(void) {
+    if(in_run) {
+        longjmp(run_jmp, 1);
+    }
+    fprintf(stderr, "mock: sleeping with nothing left to wake the CPU\n");
+    abort();
+}
+
+// Bring every model up to now, run due stimuli, then take interrupts
+static void hw_step(void) {
+    commit_write();
+    while(timer_count && timers[0].at <= now) {
+        void (*fn)(void *) = timers[0].fn;
+        void *arg = timers[0].arg;
+
+        models_update(timers[0].at);
+        memmove(&timers[0], &timers[1], (size_t)--timer_count * sizeof(timers[0]));
+        in_stimulus = true;
+        fn(arg);
+        in_stimulus = false;
+    }
+    models_update(now);
+    relevel();
+    schedule();
+    if(now >= run_end) {
+        stop_run();
+    }
+    take_interrupts();
+}
+
+static inline void advance(uint32_t cycles) {
+    now += cycles;
+    if(now >= next_event) {
+        hw_step();
+    }
+}
+
+/* ==================== Exceptions ==================== */
+
+static int next_exception(void) {
+    uint64_t ready = pending & enabled;
+    int best = -1;
+    int best_prio = cur_prio;
+
+    while(ready) {
+        int exc = __builtin_ctzll(ready);
+        ready &= ready - 1;
+        if(prio[exc] < best_prio) {
+            best = exc;
+            best_prio = prio[exc];
+        }
+    }
+    return best;
+}
+
+static void run_handler(int exc) {
+    void (*handler)(void) = handler_of(exc);
+    uint64_t start = now;
+    int saved_exc = cur_exc;
+    int saved_prio = cur_prio;
+
+    pending &= ~EXC_BIT(exc);
+    active |= EXC_BIT(exc);
+    taken++;
+    cur_exc = exc;
+    cur_prio = prio[exc];
+    exclusive = false;
+    log_event(now, MOCK_EV_IRQ_ENTER, (uint32_t)exc, 0);
+    advance(IRQ_ENTRY_CYCLES);
+
+    if(handler) {
+        handler();
+    } else {
+        fprintf(stderr, "mock: exception %d has no handler\n", exc);
+        abort();
+    }
+
+    commit_write();
+    now += IRQ_EXIT_CYCLES;
+    log_event(now, MOCK_EV_IRQ_EXIT, (uint32_t)exc, 0);
+    irq_cycles[exc] += now - start;
+    irq_count[exc]++;
+    active &= ~EXC_BIT(exc);
+    cur_exc = saved_exc;
+    cur_prio = saved_prio;
+    exclusive = false;
+    relevel();
+}
+
+static void take_interrupts(void) {
+    while(!primask && (pending & enabled)) {
+        int exc = next_exception();
+        if(exc < 0) {
+            return;
+        }
+        run_handler(exc);
+    }
+}
+
+/* ==================== Register Reads ==================== */
+
+// Put the value a read returns into the register RAM, with read side effects
+static void reg_read(uintptr_t a) {
+    if(IN(a, fio)) {
+        size_t w = OFF_IN(a, fio) / 4;
+        uint8_t port = (uint8_t)(w / 8);
+        volatile uint32_t *r = &mock_regs.fio[port * 8];
+
+        switch(w % 8) {
+            case 5: r[5] = ((gpio.latch[port] & r[0]) | (gpio.input[port] & ~r[0])) & ~r[4]; break;
+            case 6: r[6] = gpio.latch[port]; break;
+            case 7: r[7] = 0; break;
+        }
+    } else if(IN(a, systick)) {
+        models_update(now);
+        switch(OFF_IN(a, systick)) {
+            case 0x0:
+                mock_regs.systick[0] = (mock_regs.systick[0] & 7) | (systick.countflag ? 1UL << 16 : 0);
+                systick.countflag = false;
+                break;
+            case 0x8:
+                mock_regs.systick[2] = systick.val;
+                break;
+        }
+    } else if(IN(a, uart)) {
+        uint8_t u = (uint8_t)(OFF_IN(a, uart) / sizeof(LPC_UART_TypeDef));
+        LPC_UART_TypeDef *r = &mock_regs.uart[u];
+        bool dlab = r->LCR & 0x80;
+
+        models_update(now);
+        switch(OFF_IN(a, uart) % sizeof(LPC_UART_TypeDef)) {
+            case 0x00:
+                if(dlab) {
+                    r->RBR = uart[u].dll;
+                } else if(uart[u].rx_count > 0) {
+                    r->RBR = uart[u].rx_fifo[uart[u].rx_head];
+                    uart[u].rx_head = (uart[u].rx_head + 1) & 15;
+                    uart[u].rx_count--;
+                    uart[u].rx_last = now;
+                }
+                break;
+            case 0x04:
+                r->IER = dlab ? uart[u].dlm : uart[u].ier;
+                break;
+            case 0x08: {
+                uint8_t ier = uart[u].ier;
+                uint32_t id = 0x01;
+                if((ier & 4) && uart[u].overrun) {
+                    id = 0x06;
+                } else if((ier & 1) && uart[u].rx_count >= uart[u].rx_trigger) {
+                    id = 0x04;
+                } else if((ier & 1) && uart_timeout(u)) {
+                    id = 0x0C;
+                } else if((ier & 2) && uart[u].thre_int) {
+                    id = 0x02;
+                    uart[u].thre_int = false;   // Reading IIR acknowledges THRE
+                }
+                r->IIR = id | 0xC0;
+                break;
+            }
+            case 0x14:
+                r->LSR = (uart[u].rx_count ? 0x01 : 0) | (uart[u].overrun ? 0x02 : 0)
+                       | (uart[u].tx_count == 0 ? 0x20 : 0)
+                       | (uart[u].tx_count == 0 && !uart[u].tx_busy ? 0x40 : 0);
+                uart[u].overrun = false;
+                break;
+        }
+    } else if(IN(a, pwm1)) {
+        models_update(now);
+        if(a == (uintptr_t)&mock_regs.pwm1.TC) {
+            mock_regs.pwm1.TC = pwm.tc;
+        } else if(a == (uintptr_t)&mock_regs.pwm1.IR) {
+            mock_regs.pwm1.IR = pwm.ir;
+        }
+    } else if(IN(a, rtc)) {
+        LPC_RTC_TypeDef *r = &mock_regs.rtc;
+
+        models_update(now);
+        if(a == (uintptr_t)&r->ILR) {
+            r->ILR = rtc.ilr;
+        } else if(a == (uintptr_t)&r->CTIME0) {
+            RAM(a) = r->SEC | (r->MIN << 8) | (r->HOUR << 16) | (r->DOW << 24);
+        } else if(a == (uintptr_t)&r->CTIME1) {
+            RAM(a) = r->DOM | (r->MONTH << 8) | (r->YEAR << 16);
+        } else if(a == (uintptr_t)&r->CTIME2) {
+            RAM(a) = r->DOY;
+        }
+    } else if(IN(a, sc)) {
+        if(a == (uintptr_t)&mock_regs.sc.PLL0STAT) {
+            RAM(a) = (sc.pll0cfg & 0x00FF7FFF) | ((sc.pll0con & 1) ? (1UL << 24) | (1UL << 26) : 0)
+                   | ((sc.pll0con & 3) == 3 ? 1UL << 25 : 0);
+        } else if(a == (uintptr_t)&mock_regs.sc.SCS) {
+            mock_regs.sc.SCS = (mock_regs.sc.SCS & ~0x40UL) | ((mock_regs.sc.SCS & 0x20) ? 0x40 : 0);
+        }
+    } else if(IN(a, ssp)) {
+        if(OFF_IN(a, ssp) % sizeof(LPC_SSP_TypeDef) == offsetof(LPC_SSP_TypeDef, SR)) {
+            RAM(a) = 0x03;                      // TX FIFO empty, never busy
+        }
+    } else if(a == (uintptr_t)&mock_regs.scb.ICSR) {
+        uint64_t irqs = pending & ~(EXC_BIT(16) - 1);
+        mock_regs.scb.ICSR = (uint32_t)cur_exc | (irqs ? 1UL << 22 : 0)
+                           | ((pending & EXC_BIT(MOCK_EXC_SYSTICK)) ? 1UL << 26 : 0);
+    } else if(a == (uintptr_t)&mock_regs.dwt.CYCCNT) {
+        mock_regs.dwt.CYCCNT = dwt.on ? (uint32_t)(now - dwt.base) : dwt.frozen;
+    } else if(IN(a, bitband)) {
+        size_t i = OFF_IN(a, bitband) / 4;
+        reg_read(bitband[i].target);
+        mock_regs.bitband[i] = (RAM(bitband[i].target) >> bitband[i].bit) & 1;
+    }
+}
+
+/* ==================== Register Writes ==================== */
+
+static void reg_write(uintptr_t a, uint64_t cycle) {
+    uint32_t v = RAM(a);
+
+    if(IN(a, bitband)) {
+        // Bus read-modify-write of the aliased word
+        size_t i = OFF_IN(a, bitband) / 4;
+        uintptr_t target = bitband[i].target;
+        uint32_t bit = 1UL << bitband[i].bit;
+
+        reg_read(target);
+        RAM(target) = (v & 1) ? RAM(target) | bit : RAM(target) & ~bit;
+        reg_write(target, cycle);
+        return;
+    }
+    log_event(cycle, MOCK_EV_WRITE, real_addr(a), v);
+
+    if(IN(a, fio)) {
+        size_t w = OFF_IN(a, fio) / 4;
+        uint8_t port = (uint8_t)(w / 8);
+        uint32_t unmasked = ~mock_regs.fio[port * 8 + 4];
+
+        switch(w % 8) {
+            case 5: gpio.latch[port] = (gpio.latch[port] & ~unmasked) | (v & unmasked); break;
+            case 6: gpio.latch[port] |= v & unmasked; break;
+            case 7: gpio.latch[port] &= ~(v & unmasked); break;
+        }
+    } else if(IN(a, systick)) {
+        models_update(now);
+        switch(OFF_IN(a, systick)) {
+            case 0x0:
+                systick.enabled = v & 1;
+                systick.tickint = v & 2;
+                break;
+            case 0x4:
+                systick.load = v & 0xFFFFFF;
+                break;
+            case 0x8:
+                systick.val = 0;
+                systick.countflag = false;
+                break;
+        }
+    } else if(IN(a, uart)) {
+        uint8_t u = (uint8_t)(OFF_IN(a, uart) / sizeof(LPC_UART_TypeDef));
+        bool dlab = mock_regs.uart[u].LCR & 0x80;
+
+        models_update(now);
+        switch(OFF_IN(a, uart) % sizeof(LPC_UART_TypeDef)) {
+            case 0x00:
+                if(dlab) {
+                    uart[u].dll = (uint8_t)v;
+                } else {
+                    if(uart[u].tx_count < 16) {
+                        uart[u].tx_fifo[(uart[u].tx_head + uart[u].tx_count++) & 15] = (uint8_t)v;
+                    }
+                    uart[u].thre_int = false;
+                    if(!uart[u].tx_busy) {
+                        uart_tx_next(u, cycle);
+                    }
+                }
+                break;
+            case 0x04:
+                if(dlab) {
+                    uart[u].dlm = (uint8_t)v;
+                } else {
+                    // Enabling THRE with the FIFO empty raises it at once
+                    if((v & 2) && !(uart[u].ier & 2) && uart[u].tx_count == 0) {
+                        uart[u].thre_int = true;
+                    }
+                    uart[u].ier = (uint8_t)(v & 7);
+                }
+                break;
+            case 0x08: {
+                static const uint8_t trigger[4] = { 1, 4, 8, 14 };
+                uart[u].rx_trigger = trigger[(v >> 6) & 3];
+                if(v & 2) {
+                    uart[u].rx_count = 0;
+                }
+                if(v & 4) {
+                    uart[u].tx_count = 0;
+                }
+                break;
+            }
+            case 0x30:
+                if((v & 0x80) && !uart[u].tx_busy) {
+                    uart_tx_next(u, cycle);
+                }
+                break;
+        }
+    } else if(IN(a, pwm1)) {
+        LPC_PWM_TypeDef *r = &mock_regs.pwm1;
+        const volatile uint32_t *mr[7] = { &r->MR0, &r->MR1, &r->MR2, &r->MR3, &r->MR4, &r->MR5, &r->MR6 };
+
+        models_update(now);
+        if(a == (uintptr_t)&r->IR) {
+            pwm.ir &= ~v;
+        } else if(a == (uintptr_t)&r->TCR) {
+            if(v & 2) {
+                pwm.tc = 0;
+                pwm_latch();
+            }
+            pwm.running = (v & 1) && !(v & 2);
+            pwm.t = now;
+        } else if(a == (uintptr_t)&r->TC) {
+            pwm.tc = v;
+        }
+        for(uint8_t n = 0; n < 7; n++) {
+            // Outside PWM mode match registers take effect at once
+            if(a == (uintptr_t)mr[n] && !(r->TCR & 8)) {
+                pwm.active[n] = v;
+            }
+        }
+    } else if(IN(a, rtc)) {
+        models_update(now);
+        if(a == (uintptr_t)&mock_regs.rtc.ILR) {
+            rtc.ilr &= ~v;
+        } else if(a == (uintptr_t)&mock_regs.rtc.CCR) {
+            bool run = (v & 1) && !(v & 2);
+            if(run && !rtc.running) {
+                rtc.next_sec = now + mock_cpu_hz();
+            }
+            rtc.running = run;
+        }
+    } else if(IN(a, sc)) {
+        if(a == (uintptr_t)&mock_regs.sc.PLL0FEED) {
+            if(v == 0x55 && sc.feed_aa) {
+                sc.pll0con = mock_regs.sc.PLL0CON & 3;
+                sc.pll0cfg = mock_regs.sc.PLL0CFG;
+            }
+            sc.feed_aa = (v == 0xAA);
+        }
+    } else if(a == (uintptr_t)&mock_regs.scb.ICSR) {
+        if(v & (1UL << 26)) {
+            pending |= EXC_BIT(MOCK_EXC_SYSTICK);
+        }
+        if(v & (1UL << 25)) {
+            pending &= ~EXC_BIT(MOCK_EXC_SYSTICK);
+        }
+    } else if(a == (uintptr_t)&mock_regs.dwt.CYCCNT) {
+        dwt.base = now - v;
+        dwt.frozen = v;
+    } else if(a == (uintptr_t)&mock_regs.dwt.CTRL) {
+        if((v & 1) && !dwt.on) {
+            dwt.base = now - dwt.frozen;
+        } else if(!(v & 1) && dwt.on) {
+            dwt.frozen = (uint32_t)(now - dwt.base);
+        }
+        dwt.on = v & 1;
+    }
+}
+
+static void commit_write(void) {
+    if(write_pending) {
+        write_pending = false;
+        reg_write(write_addr, write_cycle);
+        relevel();
+        schedule();
+    }
+}
+
+volatile uint32_t *mock_bitband(uintptr_t addr, uint8_t bit) {
+    if(addr - MOCK_FIO_ADDR(0, 0) < sizeof(mock_regs.fio)) {
+        addr = (uintptr_t)&mock_regs.fio[(addr - MOCK_FIO_ADDR(0, 0)) / 4];
+    }
+    if(!IS_REG(addr)) {
+        fprintf(stderr, "mock: bit-band alias of %#lx, not a register\n", (unsigned long)addr);
+        abort();
+    }
+    for(uint8_t i = 0; i < bitband_count; i++) {
+        if(bitband[i].target == addr && bitband[i].bit == bit) {
+            return &mock_regs.bitband[i];
+        }
+    }
+    if(bitband_count == MOCK_BITBAND_SLOTS) {
+        fprintf(stderr, "mock: out of bit-band slots\n");
+        abort();
+    }
+    bitband[bitband_count].target = addr;
+    bitband[bitband_count].bit = bit;
+    return &mock_regs.bitband[bitband_count++];
+}
+
+/* ==================== Access Hooks ==================== */
+
+static void mem_access(void) {
+    if(write_pending) {
+        commit_write();
+        take_interrupts();
+    }
+    advance(MOCK_MEM_CYCLES);
+}
+
+static void commit_watch(void) {
+    if(watch_addr) {
+        log_event(watch_cycle, MOCK_EV_WATCH, (uint32_t)watch_addr, RAM(watch_addr));
+        watch_addr = 0;
+    }
+}
+
+static bool watched(uintptr_t a) {
+    for(uint8_t i = 0; i < watch_count; i++) {
+        if(a - (watches[i].start & ~(uintptr_t)3) < watches[i].size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void on_access(const volatile void *addr, bool write) {
+    uintptr_t a = (uintptr_t)addr & ~(uintptr_t)3;
+
+    commit_watch();
+    if(!IS_REG(a)) {
+        mem_access();
+        if(write && watch_count && watched(a)) {
+            watch_addr = a;
+            watch_cycle = now;
+        }
+        return;
+    }
+    if(write_pending) {
+        commit_write();
+    }
+    advance(MOCK_REG_CYCLES);
+    take_interrupts();                  // Before this access, after the previous one
+
+    if(write) {
+        write_pending = true;
+        write_addr = a;
+        write_cycle = now;
+    } else {
+        reg_read(a);
+    }
+}
+
+// TSan ABI (GCC -fsanitize=thread): called before every instrumented access
+#define HOOKS(n) \
+    void __tsan_read##n(void *a) { on_access(a, false); } \
+    void __tsan_write##n(void *a) { on_access(a, true); } \
+    void __tsan_volatile_read##n(void *a) { on_access(a, false); } \
+    void __tsan_volatile_write##n(void *a) { on_access(a, true); }
+#define UNALIGNED_HOOKS(n) \
+    void __tsan_unaligned_read##n(void *a) { on_access(a, false); } \
+    void __tsan_unaligned_write##n(void *a) { on_access(a, true); } \
+    void __tsan_unaligned_volatile_read##n(void *a) { on_access(a, false); } \
+    void __tsan_unaligned_volatile_write##n(void *a) { on_access(a, true); }
+
+HOOKS(1) HOOKS(2) HOOKS(4) HOOKS(8) HOOKS(16)
+UNALIGNED_HOOKS(2) UNALIGNED_HOOKS(4) UNALIGNED_HOOKS(8) UNALIGNED_HOOKS(16)
+
+void __tsan_init(void) { }
+void __tsan_func_entry(void *pc) { (void)pc; }
+void __tsan_func_exit(void) { }
+
+void __tsan_read_range(void *a, unsigned long size) {
+    (void)a;
+    advance((uint32_t)((size + 3) / 4) * MOCK_MEM_CYCLES);
+}
+
+void __tsan_write_range(void *a, unsigned long size) {
+    (void)a;
+    advance((uint32_t)((size + 3) / 4) * MOCK_MEM_CYCLES);
+}
+
+/* ==================== Core Functions ==================== */
+
+static int exc_of(IRQn_Type irq) {
+    return (irq == SysTick_IRQn) ? MOCK_EXC_SYSTICK : MOCK_EXC_IRQ(irq);
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+    commit_write();
+    enabled |= EXC_BIT(exc_of(irq));
+    relevel();
+    take_interrupts();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+    commit_write();
+    enabled &= ~EXC_BIT(exc_of(irq));
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq) {
+    commit_write();
+    pending |= EXC_BIT(exc_of(irq));
+    take_interrupts();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+    pending &= ~EXC_BIT(exc_of(irq));
+}
+
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq) {
+    return (pending & EXC_BIT(exc_of(irq))) ? 1 : 0;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    prio[exc_of(irq)] = (uint8_t)(priority & 0x1F);
+}
+
+void __disable_irq(void) {
+    commit_write();
+    primask = true;
+}
+
+void __enable_irq(void) {
+    commit_write();
+    primask = false;
+    take_interrupts();
+}
+
+uint32_t __get_PRIMASK(void) {
+    return primask;
+}
+
+void __set_PRIMASK(uint32_t value) {
+    if(value & 1) {
+        __disable_irq();
+    } else {
+        __enable_irq();
+    }
+}
+
+uint32_t __get_IPSR(void) {
+    return (uint32_t)cur_exc;
+}
+
+uint32_t __get_MSP(void) {
+    return (uint32_t)(uintptr_t)(mock_stack_limit + MOCK_STACK_WORDS);
+}
+
+// Wakes on any enabled pending exception, masked or not
+void __WFI(void) {
+    uint32_t before = taken;
+
+    hw_step();
+    while(taken == before && !(pending & enabled)) {
+        if(next_event == NEVER) {
+            stop_run();
+        }
+        now = (next_event > now) ? next_event : now + 1;
+        hw_step();
+    }
+    take_interrupts();
+}
+
+uint32_t __LDREXW(volatile uint32_t *addr) {
+    mem_access();
+    exclusive = true;
+    return *addr;
+}
+
+uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) {
+    mem_access();
+    if(!exclusive) {
+        return 1;
+    }
+    *addr = value;
+    exclusive = false;
+    return 0;
+}
+
+void __CLREX(void) {
+    exclusive = false;
+}
+
+/* ==================== Fake Boot ROM ==================== */
+
+static bool flash_range(uint32_t addr, uint32_t len) {
+    return addr >= MOCK_FLASH_BASE && len <= MOCK_FLASH_SIZE && addr - MOCK_FLASH_BASE <= MOCK_FLASH_SIZE - len;
+}
+
+static uint32_t sector_bits(uint32_t start, uint32_t end) {
+    if(start < IAP_SECTOR_FIRST || end < start || end >= IAP_SECTOR_FIRST + MOCK_FLASH_SIZE / IAP_SECTOR_SIZE) {
+        return 0;
+    }
+    return ((2UL << (end - IAP_SECTOR_FIRST)) - 1) & ~((1UL << (start - IAP_SECTOR_FIRST)) - 1);
+}
+
+static uint8_t *sector_ptr(uint32_t sector) {
+    return flash + (sector - IAP_SECTOR_FIRST) * IAP_SECTOR_SIZE;
+}
+
+void mock_iap_entry(uint32_t command[5], uint32_t result[5]) {
+    uint32_t cmd = command[0];
+    uint32_t *p = &command[1];
+
+    commit_write();
+    iap_count[cmd & 63]++;
+    result[0] = 0;
+
+    switch(cmd) {
+        case 50:                                // Prepare sectors
+            if(!sector_bits(p[0], p[1])) {
+                result[0] = 7;
+            }
+            prepared |= sector_bits(p[0], p[1]);
+            break;
+
+        case 51: {                              // Copy RAM to flash
+            uint32_t dst = p[0], len = p[2];
+            const uint8_t *src = (const uint8_t *)(uintptr_t)p[1];
+            uint32_t sector = IAP_SECTOR_FIRST + (dst - MOCK_FLASH_BASE) / IAP_SECTOR_SIZE;
+
+            if(dst & 0xFF) { result[0] = 3; break; }
+            if(p[1] & 3) { result[0] = 2; break; }
+            if(len != 256 && len != 512 && len != 1024 && len != 4096) { result[0] = 6; break; }
+            if(!flash_range(dst, len)) { result[0] = 5; break; }
+            if(!(prepared & sector_bits(sector, sector))) { result[0] = 9; break; }
+
+            uint8_t *out = flash + (dst - MOCK_FLASH_BASE);
+            uint32_t n = len;
+            if(tear_writes != UINT32_MAX && tear_writes-- == 0) {
+                n = tear_bytes;                 // Power fails part way through
+            }
+            for(uint32_t i = 0; i < n; i++) {
+                out[i] &= src[i];               // Programming only clears bits
+            }
+            if(n < len) {
+                _exit(0);
+            }
+            prepared = 0;
+            mock_advance(mock_us(MOCK_IAP_PAGE_US * (len / 256)));
+            break;
+        }
+
+        case 52: {                              // Erase sectors
+            uint32_t bits = sector_bits(p[0], p[1]);
+            if(!bits) { result[0] = 7; break; }
+            if((prepared & bits) != bits) { result[0] = 9; break; }
+            for(uint32_t s = p[0]; s <= p[1]; s++) {
+                memset(sector_ptr(s), 0xFF, IAP_SECTOR_SIZE);
+                mock_advance(mock_us(MOCK_IAP_ERASE_US));
+            }
+            prepared = 0;
+            break;
+        }
+
+        case 53: {                              // Blank check
+            if(!sector_bits(p[0], p[1])) { result[0] = 7; break; }
+            for(uint32_t s = p[0]; s <= p[1] && result[0] == 0; s++) {
+                const uint8_t *b = sector_ptr(s);
+                for(uint32_t i = 0; i < IAP_SECTOR_SIZE; i++) {
+                    if(b[i] != 0xFF) {
+                        result[0] = 8;
+                        result[1] = (uint32_t)(b + i - flash) + MOCK_FLASH_BASE;
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+
+        case 56:                                // Compare
+            if(!flash_range(p[0], p[2]) ||
+               memcmp(flash + (p[0] - MOCK_FLASH_BASE), (const void *)(uintptr_t)p[1], p[2]) != 0) {
+                result[0] = 10;
+            }
+            break;
+
+        default:
+            result[0] = 1;
+            break;
+    }
+}
+
+void mock_iap_tear(uint32_t writes, uint32_t bytes) {
+    tear_writes = writes;
+    tear_bytes = bytes;
+}
+
+uint32_t mock_iap_calls(uint32_t command) {
+    return iap_count[command & 63];
+}
+
+/* ==================== Control ==================== */
+
+static void trace_at_exit(void) {
+    const char *path = getenv("MOCK_TRACE");
+    FILE *out = path ? fopen(path, "w") : 0;
+
+    if(out) {
+        mock_log_dump(out);
+        fclose(out);
+    }
+}
+
+void mock_reset(void) {
+    static bool once = false;
+
+    if(!once) {
+        once = true;
+        flash = mmap((void *)MOCK_FLASH_BASE, MOCK_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if(flash != (uint8_t *)MOCK_FLASH_BASE) {
+            perror("mock: cannot map the fake flash at 0x70000");
+            abort();
+        }
+        memset(flash, 0xFF, MOCK_FLASH_SIZE);
+        atexit(trace_at_exit);
+    }
+
+    memset(&mock_regs, 0, sizeof(mock_regs));
+    mock_regs.sc.PCLKSEL0 = 0;
+    mock_regs.sc.PCONP = 0x042887DE;
+    mock_regs.uart[0].FDR = mock_regs.uart[1].FDR = 0x10;
+    mock_regs.uart[2].FDR = mock_regs.uart[3].FDR = 0x10;
+    for(uint8_t u = 0; u < 4; u++) {
+        mock_regs.uart[u].TER = 0x80;
+        mock_regs.uart[u].LCR = 0x03;
+    }
+    mock_regs.rtc.AMR = 0xFF;
+    *(uint32_t *)&mock_regs.scb.CPUID = 0x412FC230;   // Cortex-M3 r2p0
+
+    now = 0;
+    run_end = NEVER;
+    in_run = false;
+    write_pending = false;
+    timer_count = 0;
+    watch_addr = 0;
+    watch_count = 0;
+    pending = active = 0;
+    enabled = EXC_BIT(MOCK_EXC_SYSTICK);
+    memset(prio, 0, sizeof(prio));
+    cur_exc = 0;
+    cur_prio = THREAD_PRIO;
+    primask = false;
+    exclusive = false;
+    memset(irq_cycles, 0, sizeof(irq_cycles));
+    memset(irq_count, 0, sizeof(irq_count));
+
+    memset(&sc, 0, sizeof(sc));
+    memset(&gpio, 0, sizeof(gpio));
+    memset(gpio.input, 0xFF, sizeof(gpio.input));
+    bitband_count = 0;
+    memset(&systick, 0, sizeof(systick));
+    memset(uart, 0, sizeof(uart));
+    for(uint8_t u = 0; u < 4; u++) {
+        uart[u].base = uart_bases[u];
+        uart[u].clock = uart_clocks[u];
+        uart[u].rx_trigger = 1;
+    }
+    memset(&pwm, 0, sizeof(pwm));
+    memset(&rtc, 0, sizeof(rtc));
+    memset(&dwt, 0, sizeof(dwt));
+    log_total = 0;
+    prepared = 0;
+    memset(iap_count, 0, sizeof(iap_count));
+    tear_writes = UINT32_MAX;
+    schedule();
+}
+
+bool mock_run(void (*fn)(void), uint64_t cycles) {
+    volatile bool returned = false;  // Kept across the longjmp
+
+    run_end = now + cycles;
+    schedule();
+    in_run = true;
+    if(setjmp(run_jmp) == 0) {
+        fn();
+        returned = true;
+    }
+    in_run = false;
+    commit_write();
+    commit_watch();
+    run_end = NEVER;
+    cur_exc = 0;
+    cur_prio = THREAD_PRIO;
+    active = 0;
+    schedule();
+    return returned;
+}
+
+void mock_advance(uint64_t cycles) {
+    now += cycles;
+    hw_step();
+}
+
+void mock_at(uint64_t cycle, void (*fn)(void *arg), void *arg) {
+    uint8_t i = timer_count;
+
+    if(timer_count == MOCK_TIMERS) {
+        fprintf(stderr, "mock: too many timers\n");
+        abort();
+    }
+    while(i > 0 && timers[i - 1].at > cycle) {
+        timers[i] = timers[i - 1];
+        i--;
+    }
+    timers[i].at = cycle;
+    timers[i].fn = fn;
+    timers[i].arg = arg;
+    timer_count++;
+    schedule();
+}
+
+/* ==================== Stimuli ==================== */
+
+void mock_pin_input(uint8_t port, uint8_t bit, bool level) {
+    if(level) {
+        gpio.input[port] |= 1UL << bit;
+    } else {
+        gpio.input[port] &= ~(1UL << bit);
+    }
+}
+
+void mock_uart_rx(uint8_t u, const void *data, size_t len) {
+    const uint8_t *in = (const uint8_t *)data;
+    uint64_t at = in_stimulus ? hw_time : now;
+
+    if(uart[u].rxq_count == 0) {
+        uart[u].rx_next = at + uart_char_cycles(u);   // Stop bit of the first byte
+    }
+    for(size_t i = 0; i < len && uart[u].rxq_count < MOCK_RX_QUEUE; i++) {
+        uart[u].rx_queue[(uart[u].rxq_head + uart[u].rxq_count++) % MOCK_RX_QUEUE] = in[i];
+    }
+    schedule();
+}
+
+/* ==================== Observations ==================== */
+
+void mock_watch(const volatile void *addr, size_t size) {
+    if(watch_count == MOCK_WATCHES) {
+        fprintf(stderr, "mock: too many watches\n");
+        abort();
+    }
+    watches[watch_count].start = (uintptr_t)addr;
+    watches[watch_count].size = size + ((uintptr_t)addr & 3);
+    watch_count++;
+}
+
+size_t mock_log_count(void) {
+    return (log_total < MOCK_LOG_SIZE) ? log_total : MOCK_LOG_SIZE;
+}
+
+const mock_event_t *mock_log(size_t index) {
+    return &log_buf[(log_total - mock_log_count() + index) % MOCK_LOG_SIZE];
+}
+
+void mock_log_dump(FILE *out) {
+    static const char *const kinds[] = { "write", "irq", "irq_exit", "match", "tx", "watch" };
+
+    for(size_t i = 0; i < mock_log_count(); i++) {
+        const mock_event_t *e = mock_log(i);
+        fprintf(out, "%12llu %-8s %08x %08x\n", (unsigned long long)e->cycle,
+                kinds[e->kind], (unsigned)e->addr, (unsigned)e->value);
+    }
+}
+
+const mock_tx_t *mock_uart_tx(uint8_t u, size_t *count) {
+    *count = uart[u].tx_logged;
+    return uart[u].tx_log;
+}
+
+uint32_t mock_uart_overruns(uint8_t u) {
+    return uart[u].overruns;
+}
+
+uint64_t mock_irq_cycles(int exception) {
+    return irq_cycles[exception];
+}
+
+uint32_t mock_irq_count(int exception) {
+    return irq_count[exception];
+}
@@ -0,0 +1,172 @@
+/**
+ * @file mock.h
+ * @brief LPC1768 register mock for host builds, on a virtual cycle clock
+ * @note The firmware is compiled with -fsanitize=thread and
+ *       --param=tsan-distinguish-volatile=1, but linked against the hooks
+ *       in mock.c instead of the TSan runtime, so every load and store
+ *       calls the mock first. This relies on GCC's internal __tsan_* hook
+ *       ABI (names, arguments, which accesses get a hook), which has no
+ *       stability promise: CMakeLists.txt pins the GCC versions it was
+ *       checked with. Plain accesses cost MOCK_MEM_CYCLES, register
+ *       accesses MOCK_REG_CYCLES and get the peripheral behaviour: FIOSET
+ *       and FIOMASK, SysTick VAL and COUNTFLAG, UART FIFOs at the line
+ *       rate, PWM1 matches with shadow latches, RTC seconds and the PLL
+ *       feed. Register writes are logged with their cycle. Interrupts are
+ *       taken between accesses with NVIC priority and PRIMASK rules, and
+ *       WFI skips ahead to the next hardware event.
+ *
+ *       The clock is a cost proxy for comparing builds and spotting
+ *       regressions, not a cycle-accurate Cortex-M3: instructions that
+ *       touch no memory are free. Not modelled: GPDMA (plain RAM), TIMERn
+ *       counting, SSP transfers (always idle), GPIO interrupts (EINT3), pin
+ *       levels of PWM outputs, deep sleep (a plain WFI).
+ */
+
+#ifndef MOCK_H
+#define MOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* ==================== Configuration ==================== */
+#define MOCK_MEM_CYCLES     1       // Load or store to RAM or flash
+#define MOCK_REG_CYCLES     2       // Peripheral access, bridge wait state
+
+#define MOCK_LOG_SIZE       (1UL << 18)  // Events kept, oldest dropped first
+#define MOCK_TX_CAPTURE     65536   // Bytes kept per UART
+#define MOCK_RX_QUEUE       4096    // Bytes waiting to arrive per UART
+#define MOCK_TIMERS         64      // mock_at() callbacks pending at once
+#define MOCK_WATCHES        4       // mock_watch() ranges
+
+#define MOCK_FLASH_BASE     0x70000UL    // Sectors 28 and 29 (store)
+#define MOCK_FLASH_SIZE     0x10000UL
+#define MOCK_IAP_PAGE_US    1000    // Boot ROM time per 256-byte write
+#define MOCK_IAP_ERASE_US   100000  // Per 32 KB sector erase
+
+/* ==================== Event Log ==================== */
+typedef enum {
+    MOCK_EV_WRITE,          // Register write: addr, value written
+    MOCK_EV_IRQ_ENTER,      // Handler entry: addr = exception number
+    MOCK_EV_IRQ_EXIT,
+    MOCK_EV_MATCH,          // PWM1 match: value = match index (0-6)
+    MOCK_EV_TX,             // UART byte fully sent: addr = UART base, value = byte
+    MOCK_EV_WATCH           // Store to a mock_watch() range: addr, value of the word
+} mock_kind_t;
+
+typedef struct {
+    uint64_t cycle;
+    uint32_t addr;          // Real LPC17xx address for registers, host address for RAM
+    uint32_t value;
+    mock_kind_t kind;
+} mock_event_t;
+
+typedef struct {
+    uint64_t start;         // First bit on the line
+    uint64_t end;           // Stop bit done
+    uint8_t byte;
+} mock_tx_t;
+
+// Real addresses of the registers the benchmarks look for
+#define MOCK_FIO_ADDR(port, off)  (0x2009C000UL + (port) * 0x20UL + (off))
+#define MOCK_UART2_BASE     0x40098000UL
+#define MOCK_PWM1_BASE      0x40018000UL
+#define MOCK_EXC_SYSTICK    15
+#define MOCK_EXC_IRQ(n)     (16 + (n))
+
+/* ==================== Control ==================== */
+
+/**
+ * @brief Power-on reset: registers, clock, NVIC, log, captures and timers
+ * @note The fake flash keeps its contents (mapped shared, so it also
+ *       survives into fork()ed children)
+ */
+void mock_reset(void);
+
+/**
+ * @brief Run firmware code until it returns or the clock reaches a limit
+ * @param fn Entry point, e.g. the firmware main() built as app_main
+ * @param cycles Virtual cycles from now
+ * @return true if fn returned, false if time ran out (or it slept forever)
+ * @example mock_run(firmware, mock_ms(2000));
+ */
+bool mock_run(void (*fn)(void), uint64_t cycles);
+
+/**
+ * @brief Let time pass without running code (boot ROM calls)
+ * @param cycles Virtual cycles, events pend but nothing is taken
+ */
+void mock_advance(uint64_t cycles);
+
+/**
+ * @brief Call a function when the clock reaches a cycle
+ * @param cycle Absolute virtual cycle
+ * @param fn Runs on the hardware side (inputs, stimuli), not as firmware
+ * @param arg Passed to fn
+ */
+void mock_at(uint64_t cycle, void (*fn)(void *arg), void *arg);
+
+uint64_t mock_cycles(void);
+uint32_t mock_cpu_hz(void);     // CCLK from the SC registers
+
+// Virtual cycles for a duration at the current CCLK
+uint64_t mock_ms(uint32_t ms);
+uint64_t mock_us(uint32_t us);
+
+/* ==================== Stimuli ==================== */
+
+/**
+ * @brief Drive an input pin from outside
+ * @param port GPIO port 0-4
+ * @param bit Pin 0-31
+ * @param level Level read through FIOPIN while the pin is an input
+ * @note Undriven inputs read high, as with the pull-ups the firmware uses
+ */
+void mock_pin_input(uint8_t port, uint8_t bit, bool level);
+
+/**
+ * @brief Start receiving bytes, back to back at the UART's line rate
+ * @param uart 0-3
+ * @param data Bytes, queued behind any still arriving
+ * @param len Byte count
+ */
+void mock_uart_rx(uint8_t uart, const void *data, size_t len);
+
+/* ==================== Observations ==================== */
+
+/**
+ * @brief Log every firmware store to a variable, e.g. a state in main.c
+ * @param addr Start of the variable
+ * @param size Bytes
+ * @note Logged as MOCK_EV_WATCH with the aligned word as it is after the
+ *       store. Cleared by mock_reset().
+ */
+void mock_watch(const volatile void *addr, size_t size);
+
+size_t mock_log_count(void);
+const mock_event_t *mock_log(size_t index);  // 0 = oldest kept
+void mock_log_dump(FILE *out);               // Also at exit if MOCK_TRACE=path
+
+/**
+ * @brief Bytes sent by a UART since reset
+ * @param uart 0-3
+ * @param count Bytes in the returned array
+ */
+const mock_tx_t *mock_uart_tx(uint8_t uart, size_t *count);
+
+uint32_t mock_uart_overruns(uint8_t uart);  // RX bytes lost to a full FIFO
+uint64_t mock_irq_cycles(int exception);     // Spent in a handler (inclusive)
+uint32_t mock_irq_count(int exception);
+uint32_t mock_iap_calls(uint32_t command);   // Boot ROM calls by command
+
+/**
+ * @brief Power loss in the middle of the n-th page write from now
+ * @param writes IAP copy commands to let through first
+ * @param bytes Bytes of the torn page that get programmed
+ * @note The process _exit()s from inside the ROM call: run the boot in a
+ *       fork()ed child, the parent sees the flash as it was left
+ */
+void mock_iap_tear(uint32_t writes, uint32_t bytes);
+
+#endif // MOCK_H
@@ -0,0 +1,39 @@
+/**
+ * @file mock_config.h
+ * @brief Forced include (-include) of every host build: routes the fixed
+ *        register addresses of the HAL to the mock
+ * @note The CMSIS blocks come from host/include/lpc17xx.h. These are the
+ *       registers the HAL addresses by number, each behind an #ifndef in
+ *       its own header.
+ */
+
+#ifndef MOCK_CONFIG_H
+#define MOCK_CONFIG_H
+
+#include <stdint.h>
+#include <lpc17xx.h>
+
+/* ==================== Core Registers ==================== */
+#define SYSTICK_BASE            ((uintptr_t)mock_regs.systick)
+#define SCB_ICSR                (mock_regs.scb.ICSR)
+#define SCB_SCR                 (mock_regs.scb.SCR)
+#define DEMCR                   (mock_regs.coredebug.DEMCR)
+#define DWT_CTRL                (mock_regs.dwt.CTRL)
+#define DWT_CYCCNT              (mock_regs.dwt.CYCCNT)
+
+/* ==================== GPIO ==================== */
+#define GPIO_FIO_REG(port, off) (mock_regs.fio[((port) * 0x20 + (off)) / 4])
+
+// Alias word of one bit, decoded back to the register by the mock
+#define GPIO_BITBAND(addr, bit) (*mock_bitband((uintptr_t)(addr), (bit)))
+volatile uint32_t *mock_bitband(uintptr_t addr, uint8_t bit);
+
+/* ==================== Boot ROM and Linker Symbols ==================== */
+// Fake IAP on the two store sectors, mapped at their real addresses
+#define IAP_ENTRY_ADDR          ((uintptr_t)mock_iap_entry)
+void mock_iap_entry(uint32_t command[5], uint32_t result[5]);
+
+#define DIAG_STACK_LIMIT        mock_stack_limit
+#define DIAG_STACK_TOP          mock_stack_top
+
+#endif // MOCK_CONFIG_H
@@ -0,0 +1,221 @@
+/**
+ * @file test_store.c
+ * @brief Record store on the fake IAP: power cycles, torn writes, wraps
+ * @note Each boot is a fork()ed child, so the store's RAM starts over
+ *       while the flash (mapped shared) keeps what was programmed. The
+ *       parent keeps the last committed value in shared memory and every
+ *       boot must load exactly that one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "mock.h"
+#include "store.h"
+#include "systick.h"
+#include "swtimer.h"
+
+#define BOOTS               300
+#define COMMITS_PER_BOOT    4       // 1200 commits: 9 sector wraps
+#define TEAR_EVERY          7       // Boots that lose power mid-write
+
+#define IAP_CMD_COPY        51
+#define IAP_CMD_ERASE       52
+
+#define CHECK(cond) do { \
+    if(!(cond)) { \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        _exit(1); \
+    } \
+} while(0)
+
+typedef struct {
+    uint32_t counter;
+    uint8_t fill[40];               // Length varies with the counter
+} record_t;
+
+// Shared with the children
+static struct {
+    uint32_t committed;             // Counter of the last record flushed, 0 = none
+    uint32_t torn;                  // Record being written at the power loss
+    uint32_t torn_kept;             // Torn writes that still left a full record
+    uint32_t erases;
+    uint32_t writes;
+    uint32_t erase_ms[8];           // millis() across flushes that erased
+    uint32_t erase_count;
+} *shared;
+
+typedef void (*boot_t)(uint32_t arg);
+
+static boot_t boot_fn;
+static uint32_t boot_arg;
+
+static size_t record_len(uint32_t counter) {
+    return offsetof(record_t, fill) + counter % sizeof(((record_t *)0)->fill);
+}
+
+static void make_record(record_t *r, uint32_t counter) {
+    r->counter = counter;
+    for(size_t i = 0; i < sizeof(r->fill); i++) {
+        r->fill[i] = (uint8_t)(counter * 7 + i);
+    }
+}
+
+// Firmware side of a boot: what main() does, then the scenario
+static void boot_main(void) {
+    record_t expect, got;
+    size_t len;
+
+    systick_init();
+    swtimer_init();
+    CHECK(store_init() == (shared->committed != 0 || shared->torn != 0));
+
+    // A write torn after the record's last byte left it complete
+    len = store_load(&got, sizeof(got));
+    if(shared->torn && len >= sizeof(got.counter) && got.counter == shared->torn) {
+        shared->committed = shared->torn;
+        shared->torn_kept++;
+    }
+    shared->torn = 0;
+    if(shared->committed) {
+        make_record(&expect, shared->committed);
+        CHECK(len == record_len(shared->committed));
+        CHECK(memcmp(&got, &expect, len) == 0);
+    } else {
+        CHECK(len == 0);
+    }
+    boot_fn(boot_arg);
+}
+
+// Power-on in a child, the parent waits for it to finish or lose power
+static int boot(boot_t fn, uint32_t arg) {
+    pid_t pid = fork();
+    int status;
+
+    if(pid == 0) {
+        mock_reset();
+        boot_fn = fn;
+        boot_arg = arg;
+        if(!mock_run(boot_main, UINT64_MAX / 2)) {
+            _exit(3);
+        }
+        shared->erases += mock_iap_calls(IAP_CMD_ERASE);
+        shared->writes += mock_iap_calls(IAP_CMD_COPY);
+        _exit(0);
+    }
+    if(pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+/* ==================== Scenarios ==================== */
+
+static void nothing(uint32_t arg) {
+    (void)arg;
+}
+
+// Commit n records, each one new
+static void commit(uint32_t n) {
+    record_t r;
+
+    while(n--) {
+        uint32_t next = shared->committed + 1;
+        uint32_t erases = mock_iap_calls(IAP_CMD_ERASE);
+        uint32_t start = millis();
+
+        make_record(&r, next);
+        CHECK(store_save(&r, record_len(next)));
+        CHECK(store_flush());
+        shared->committed = next;
+
+        // Ticks lost while the ROM had the flash must be caught up
+        if(mock_iap_calls(IAP_CMD_ERASE) != erases && shared->erase_count < 8) {
+            shared->erase_ms[shared->erase_count++] = millis() - start;
+        }
+    }
+}
+
+// Power fails half way through the write of the next record
+static void torn(uint32_t bytes) {
+    record_t r;
+
+    make_record(&r, shared->committed + 1);
+    shared->torn = r.counter;
+    mock_iap_tear(0, bytes);
+    CHECK(store_save(&r, record_len(shared->committed + 1)));
+    store_flush();
+    CHECK(!"survived the power loss");
+}
+
+// Saves are batched: nothing reaches the flash before the commit delay
+static void batched(uint32_t arg) {
+    record_t r;
+    uint32_t start = millis();
+
+    (void)arg;
+    for(uint32_t i = 1; i <= 3; i++) {
+        make_record(&r, shared->committed + i);
+        CHECK(store_save(&r, record_len(shared->committed + i)));
+        CHECK(store_save(&r, record_len(shared->committed + i)));
+    }
+    while(millis() - start < STORE_COMMIT_MS - 10) {
+        swtimer_run();
+    }
+    CHECK(mock_iap_calls(IAP_CMD_COPY) == 0);
+    while(millis() - start < STORE_COMMIT_MS + 10) {
+        swtimer_run();
+    }
+    CHECK(mock_iap_calls(IAP_CMD_COPY) == 1);
+    shared->committed += 3;
+}
+
+int main(void) {
+    uint32_t tears = 0, commits = 0;
+    int rc;
+    bool ok = true;
+
+    shared = mmap(0, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    memset(shared, 0, sizeof(*shared));
+    mock_reset();                   // Maps the blank fake flash
+
+    ok &= (boot(nothing, 0) == 0);  // Empty store
+    ok &= (boot(batched, 0) == 0);
+    for(uint32_t i = 0; i < BOOTS && ok; i++) {
+        if(i % TEAR_EVERY == TEAR_EVERY - 1) {
+            rc = boot(torn, 1 + (i * 37) % 64);  // Header or data, the rest stays 0xFF
+            tears++;
+        } else {
+            rc = boot(commit, COMMITS_PER_BOOT);
+            commits += COMMITS_PER_BOOT;
+        }
+        if(rc != 0) {
+            fprintf(stderr, "boot %u failed (%d)\n", (unsigned)i, rc);
+            ok = false;
+        }
+    }
+    ok &= (boot(nothing, 0) == 0);  // Reads back the last one
+
+    printf("store: %u boots, %u commits, %u torn writes (%u complete)\n", (unsigned)BOOTS,
+           (unsigned)commits, (unsigned)tears, (unsigned)shared->torn_kept);
+    printf("flash: %u page writes, %u sector erases\n", (unsigned)shared->writes, (unsigned)shared->erases);
+    for(uint32_t i = 0; i < shared->erase_count; i++) {
+        printf("millis() across flush with erase: %u ms\n", (unsigned)shared->erase_ms[i]);
+        ok &= shared->erase_ms[i] >= MOCK_IAP_ERASE_US / 1000 && shared->erase_ms[i] <= MOCK_IAP_ERASE_US / 1000 + 3;
+    }
+
+    // One erase per sector's worth of pages (the first time round is blank)
+    uint32_t pages = shared->writes;
+    ok &= shared->erases >= pages / 128 - 1 && shared->erases <= pages / 128 + 1;
+    ok &= shared->erase_count > 0 && shared->torn_kept < tears;
+
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
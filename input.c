@@ -0,0 +1,93 @@
+/**
+ * @file input.c
+ * @brief Non-blocking button scanning and debounce implementation
+ */
+
+#include "input.h"
+#include "gpio.h"
+#include "swtimer.h"
+#include "profile.h"
+#include "event.h"
+
+/* ==================== Pin Definitions ==================== */
+
+// Button pins (active low, internal pull-up)
+#define BTN_COUNTDOWN   P1_20  // Switch to countdown mode
+#define BTN_SET         P1_21  // Increment time in set mode
+#define BTN_START       P1_22  // Start/Pause toggle
+#define BTN_RESET       P1_23  // Reset timer
+
+// Buttons are contiguous, so one port read samples all of them
+#define BTN_PORT        GPIO_PORT_OF(BTN_COUNTDOWN)
+#define BTN_SHIFT       (BTN_COUNTDOWN & 0x1F)
+#define BTN_BITS        ((1 << BUTTON_COUNT) - 1)
+
+// Pin map: all buttons are inputs with pull-up
+static const gpio_pin_cfg_t button_pins[] = {
+    GPIO_CFG_IN(BTN_COUNTDOWN, GPIO_PULL_UP),
+    GPIO_CFG_IN(BTN_SET, GPIO_PULL_UP),
+    GPIO_CFG_IN(BTN_START, GPIO_PULL_UP),
+    GPIO_CFG_IN(BTN_RESET, GPIO_PULL_UP)
+};
+
+#define LONG_PRESS_SCANS  (INPUT_LONG_PRESS_MS / INPUT_SCAN_MS)
+
+/* ==================== Debounce State ==================== */
+
+// Vertical counter: bit n of (ct1:ct0) is a 2-bit counter for button n,
+// so all buttons are debounced in parallel with a handful of logic ops
+static uint8_t ct0 = 0xFF;
+static uint8_t ct1 = 0xFF;
+static volatile uint8_t debounced = 0;  // 1 = pressed
+static swtimer_t scan_timer;
+static uint16_t hold_scans[BUTTON_COUNT];
+
+/* ==================== Public Functions ==================== */
+
+void input_init(void) {
+    gpio_config_table(button_pins, sizeof(button_pins) / sizeof(button_pins[0]));
+
+    swtimer_setup(&scan_timer, input_scan, 0, SWTIMER_ISR);
+    swtimer_start(&scan_timer, INPUT_SCAN_MS, INPUT_SCAN_MS);
+}
+
+void input_scan(void *arg) {
+    (void)arg;
+    PROFILE_ENTER(input_scan);
+
+    // Single read of all buttons, active low -> 1 = pressed
+    uint8_t sample = ~(gpio_port_read(BTN_PORT) >> BTN_SHIFT) & BTN_BITS;
+
+    // Count consecutive samples that differ from the debounced level,
+    // a bit toggles only after 4 in a row
+    uint8_t changed = debounced ^ sample;
+    ct0 = ~(ct0 & changed);
+    ct1 = ct0 ^ (ct1 & changed);
+    uint8_t toggled = changed & ct0 & ct1;
+    uint8_t level = debounced ^ toggled;
+    debounced = level;
+
+    // Press/release edges
+    for (uint8_t i = 0; toggled; i++, toggled >>= 1) {
+        if (toggled & 1) {
+            hold_scans[i] = 0;
+            event_post(EVENT_SRC_SYSTICK, EVENT_BUTTON, i,
+                       (level & (1 << i)) ? INPUT_PRESS : INPUT_RELEASE);
+        }
+    }
+
+    // Long press, reported once when the hold time is reached
+    for (uint8_t i = 0, held = level; held; i++, held >>= 1) {
+        if ((held & 1) && hold_scans[i] < LONG_PRESS_SCANS) {
+            if (++hold_scans[i] == LONG_PRESS_SCANS) {
+                event_post(EVENT_SRC_SYSTICK, EVENT_BUTTON, i, INPUT_LONG);
+            }
+        }
+    }
+
+    PROFILE_EXIT(input_scan);
+}
+
+uint8_t input_state(void) {
+    return debounced;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file input.h
+ * @brief Non-blocking button scanning and debounce for LPC1768
+ * @note All buttons sit on one port and are sampled with a single read
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ==================== Configuration ==================== */
+// Sample period in ms (debounce time = 4 * INPUT_SCAN_MS)
+#ifndef INPUT_SCAN_MS
+#define INPUT_SCAN_MS        5
+#endif
+
+// Hold time before a long-press event is reported
+#ifndef INPUT_LONG_PRESS_MS
+#define INPUT_LONG_PRESS_MS  1000
+#endif
+
+/* ==================== Buttons ==================== */
+typedef enum {
+    BUTTON_COUNTDOWN = 0,  // P1.20 - Switch to countdown mode
+    BUTTON_SET       = 1,  // P1.21 - Increment time in set mode
+    BUTTON_START     = 2,  // P1.22 - Start/Pause toggle
+    BUTTON_RESET     = 3,  // P1.23 - Reset timer
+    BUTTON_COUNT
+} button_t;
+
+/* ==================== Events ==================== */
+// Posted as EVENT_BUTTON (id = button_t, value = input_event_type_t)
+typedef enum {
+    INPUT_PRESS   = 0,  // Debounced press
+    INPUT_RELEASE = 1,  // Debounced release
+    INPUT_LONG    = 2   // Held for INPUT_LONG_PRESS_MS (sent once per press)
+} input_event_type_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Configure button pins and start the periodic scan timer
+ * @note Call after swtimer_init() and event_init()
+ */
+void input_init(void);
+
+/**
+ * @brief Sample and debounce all buttons (swtimer callback, SysTick context)
+ * @param arg Unused
+ * @note Runs every INPUT_SCAN_MS from the software timer started by input_init()
+ */
+void input_scan(void *arg);
+
+/**
+ * @brief Get the current debounced button levels
+ * @return Bit n set if button n is held down
+ */
+uint8_t input_state(void);
+
+#endif // INPUT_H
@@ -3,223 +3,398 @@
  * @brief Countdown Timer with 4-digit 7-segment display
  */
 
+#include "clock.h"
 #include "gpio.h"
 #include "systick.h"
+#include "swtimer.h"
+#include "sched.h"
+#include "profile.h"
+#include "diag.h"
+#include "display.h"
+#include "input.h"
+#include "event.h"
+#include "telemetry.h"
+#include "console.h"
+#include "frame.h"
+#include "rtc.h"
+#include "store.h"
+#include "countdown.h"
 
-// Button pins
-#define BTN_COUNTDOWN   P1_20  // Switch to countdown mode
-#define BTN_SET         P1_21  // Increment time in set mode
-#define BTN_START       P1_22  // Start/Pause toggle
-#define BTN_RESET       P1_23  // Reset timer
-
-// 7-segment pins (segments a-h)
-#define SEG_A   P0_0
-#define SEG_B   P0_1
-#define SEG_C   P0_2
-#define SEG_D   P0_3
-#define SEG_E   P0_4
-#define SEG_F   P0_5
-#define SEG_G   P0_6
-#define SEG_DP  P0_7  // Decimal point
-
-// Digit enable pins (common cathode/anode)
-#define DIGIT_1   P2_0  // Leftmost digit
-#define DIGIT_2   P2_1
-#define DIGIT_3   P2_2
-#define DIGIT_4   P2_3  // Rightmost digit
-
-// 7-segment patterns (common cathode: 1=on, 0=off)
-const uint8_t seg_patterns[10] = {
-    0x3F, // 0: abcdef
-    0x06, // 1: bc
-    0x5B, // 2: abdeg
-    0x4F, // 3: abcdg
-    0x66, // 4: bcfg
-    0x6D, // 5: acdfg
-    0x7D, // 6: acdefg
-    0x07, // 7: abc
-    0x7F, // 8: abcdefg
-    0x6F  // 9: abcdfg
+// Display paging between countdown channels
+#define PAGE_MS          3000  // Auto-paging interval
+#define BANNER_MS        750   // Channel number shown after a page change
+#define SEG_LETTER_C     0x39  // "C": segments a, d, e, f
+#define TENTHS_MS        100   // Redraw interval in tenths mode
+
+// Record kept in flash, bump SAVED_VERSION when the layout changes
+#define SAVED_VERSION    1
+
+typedef struct {
+    uint8_t version;
+    uint8_t tenths;
+    countdown_snapshot_t countdown;
+} saved_t;
+
+// Tasks, in priority order (PRIO_TICK is the countdown's own tick task)
+enum { PRIO_INPUT, PRIO_TICK, PRIO_DISPLAY, PRIO_TELEMETRY, PRIO_SAVE };
+sched_task_t input_task;      // Button events, released by event_post()
+sched_task_t wake_task;       // Leaves standby, released by the RTC alarm
+sched_task_t display_task;    // Framebuffer update, released on value change
+sched_task_t page_task;       // Next channel, periodic in auto-paging mode
+sched_task_t telemetry_task;  // Periodic status report
+sched_task_t save_task;       // Hands the state to the store, released on change
+
+uint8_t shown = 0;            // Channel on the display, buttons act on it
+uint32_t shown_value = 0xFFFFFFFF;  // Time on the display, invalid = redraw
+bool banner = false;          // Showing "C  n" instead of the time
+bool tenths = false;          // Last minute shown as " SS.t"
+bool standby = false;         // Deep-sleep until the next expiry
+swtimer_t banner_timer;       // Ends the banner
+
+// State machine event for a press of each button
+static const uint8_t button_events[BUTTON_COUNT] = {
+    [BUTTON_COUNTDOWN] = CD_EV_LOAD,
+    [BUTTON_SET]       = CD_EV_ADD_10S,
+    [BUTTON_START]     = CD_EV_START_PAUSE,
+    [BUTTON_RESET]     = CD_EV_RESET
 };
 
-const uint8_t seg_pins[8] = {SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G, SEG_DP};
-const uint8_t digit_pins[4] = {DIGIT_1, DIGIT_2, DIGIT_3, DIGIT_4};
+/* ==================== Display Paging ==================== */
 
-// Timer state
-typedef enum {
-    STATE_SET,
-    STATE_RUNNING,
-    STATE_PAUSED,
-    STATE_DONE
-} timer_state_t;
+void redraw(void) {
+    shown_value = 0xFFFFFFFF;
+    sched_post(&display_task);
+}
 
-volatile timer_state_t state = STATE_SET;
-volatile uint32_t timer_value = 0;  // In seconds
-volatile uint32_t set_value = 60;   // Default 60 seconds
-volatile uint32_t last_tick = 0;
-volatile uint8_t btn_start_prev = 0;
-volatile uint8_t btn_countdown_prev = 0;
-volatile uint8_t btn_set_prev = 0;
-volatile uint8_t btn_reset_prev = 0;
+void show_channel(uint8_t channel) {
+    shown = channel;
+    banner = true;
+    swtimer_start(&banner_timer, BANNER_MS, 0);
+    redraw();
+}
 
-void display_init(void) {
-    // Configure segment pins
-    for(uint8_t i = 0; i < 8; i++) {
-        gpio_config(seg_pins[i], GPIO_OUTPUT, GPIO_PULL_NONE);
-        gpio_write(seg_pins[i], GPIO_LOW);
-    }
-    
-    // Configure digit enable pins
-    for(uint8_t i = 0; i < 4; i++) {
-        gpio_config(digit_pins[i], GPIO_OUTPUT, GPIO_PULL_NONE);
-        gpio_write(digit_pins[i], GPIO_LOW);
+void banner_done(void *arg) {
+    (void)arg;
+    banner = false;
+    redraw();
+}
+
+/* ==================== Standby ==================== */
+// Tickless: SysTick and the display stop, the RTC alarm of the first
+// expiring channel wakes us. Buttons and the console cannot wake it.
+
+// Scheduler idle hook, IRQs masked
+void idle(void) {
+    if(standby && uart_tx_idle(TELEMETRY_UART)) {
+        clock_deep_sleep();  // Console reply flushed
+    } else {
+        systick_idle();
     }
 }
 
-void buttons_init(void) {
-    gpio_config(BTN_COUNTDOWN, GPIO_INPUT, GPIO_PULL_UP);
-    gpio_config(BTN_SET, GPIO_INPUT, GPIO_PULL_UP);
-    gpio_config(BTN_START, GPIO_INPUT, GPIO_PULL_UP);
-    gpio_config(BTN_RESET, GPIO_INPUT, GPIO_PULL_UP);
+// RTC alarm (interrupt context)
+void standby_alarm(void) {
+    sched_post(&wake_task);
 }
 
-void write_segment(uint8_t pattern) {
-    for(uint8_t i = 0; i < 7; i++) {
-        gpio_write(seg_pins[i], (pattern >> i) & 1);
-    }
+void standby_exit(void *arg) {
+    (void)arg;
+    standby = false;
+    countdown_resume();
+    display_enable(true);
+    redraw();
 }
 
-void display_digit(uint8_t digit_pos, uint8_t value, uint8_t dp) {
-    // Turn off all digits
-    for(uint8_t i = 0; i < 4; i++) {
-        gpio_write(digit_pins[i], GPIO_LOW);
+void page_next(void *arg) {
+    (void)arg;
+    show_channel((shown + 1) % COUNTDOWN_CHANNELS);
+}
+
+/* ==================== Console Commands ==================== */
+// Commands feed the same state machine as the buttons. The optional
+// channel argument (1-based) defaults to the channel on the display.
+
+// Channel named by argv[index], COUNTDOWN_CHANNELS if invalid
+uint8_t arg_channel(uint8_t argc, char *argv[], uint8_t index) {
+    uint32_t n = 0;
+    
+    if(argc <= index) {
+        return shown;
+    }
+    if(argc > index + 1) {
+        return COUNTDOWN_CHANNELS;
     }
+    for(const char *s = argv[index]; *s; s++) {
+        if(*s < '0' || *s > '9' || n > COUNTDOWN_CHANNELS) {
+            return COUNTDOWN_CHANNELS;
+        }
+        n = n * 10 + (*s - '0');
+    }
+    return (n >= 1 && n <= COUNTDOWN_CHANNELS) ? n - 1 : COUNTDOWN_CHANNELS;
+}
+
+// set MM:SS [channel] (set mode only)
+int cmd_set(uint8_t argc, char *argv[]) {
+    const char *s = argv[1];
+    uint8_t ch = arg_channel(argc, argv, 2);
     
-    // Write segment pattern
-    if(value <= 9) {
-        write_segment(seg_patterns[value]);
-    } else {
-        write_segment(0x00);  // Blank
+    if(argc < 2 || ch == COUNTDOWN_CHANNELS) {
+        return -1;
+    }
+    for(uint8_t i = 0; i < 5; i++) {
+        if(i == 2 ? s[i] != ':' : (s[i] < '0' || s[i] > '9')) {
+            return -1;
+        }
+    }
+    if(s[5] != '\0' || s[3] > '5') {
+        return -1;
     }
     
-    // Decimal point
-    gpio_write(SEG_DP, dp);
+    mmss_t value = MMSS(s[0] - '0', s[1] - '0', s[3] - '0', s[4] - '0');
+    return countdown_dispatch(ch, CD_EV_SET_TIME, value.word) ? 0 : -1;
+}
+
+// start/pause/reset [channel]
+int cmd_event(uint8_t argc, char *argv[], countdown_event_t event) {
+    uint8_t ch = arg_channel(argc, argv, 1);
     
-    // Enable selected digit
-    gpio_write(digit_pins[digit_pos], GPIO_HIGH);
+    if(ch == COUNTDOWN_CHANNELS) {
+        return -1;
+    }
+    return countdown_dispatch(ch, event, 0) ? 0 : -1;
 }
 
-void display_number(uint16_t number) {
-    static uint8_t current_digit = 0;
+int cmd_start(uint8_t argc, char *argv[]) {
+    return cmd_event(argc, argv, CD_EV_START);
+}
+
+int cmd_pause(uint8_t argc, char *argv[]) {
+    return cmd_event(argc, argv, CD_EV_PAUSE);
+}
+
+int cmd_reset(uint8_t argc, char *argv[]) {
+    return cmd_event(argc, argv, CD_EV_RESET);
+}
+
+// show <channel>|auto
+int cmd_show(uint8_t argc, char *argv[]) {
+    const char *s = argv[1];
     
-    uint8_t d1 = (number / 1000) % 10;
-    uint8_t d2 = (number / 100) % 10;
-    uint8_t d3 = (number / 10) % 10;
-    uint8_t d4 = number % 10;
+    if(argc == 2 && s[0] == 'a' && s[1] == 'u' && s[2] == 't' && s[3] == 'o' && s[4] == '\0') {
+        sched_every(&page_task, PAGE_MS);
+        return 0;
+    }
     
-    // Multiplex display
-    switch(current_digit) {
-        case 0: display_digit(0, d1, 0); break;
-        case 1: display_digit(1, d2, 1); break;  // DP after second digit (MM:SS)
-        case 2: display_digit(2, d3, 0); break;
-        case 3: display_digit(3, d4, 0); break;
+    uint8_t ch = arg_channel(argc, argv, 1);
+    if(argc != 2 || ch == COUNTDOWN_CHANNELS) {
+        return -1;
     }
+    sched_stop(&page_task);
+    show_channel(ch);
+    return 0;
+}
+
+// tenths on|off
+int cmd_tenths(uint8_t argc, char *argv[]) {
+    const char *s = argv[1];
+    bool on = argc == 2 && s[0] == 'o' && s[1] == 'n' && s[2] == '\0';
+    bool off = argc == 2 && s[0] == 'o' && s[1] == 'f' && s[2] == 'f' && s[3] == '\0';
     
-    current_digit = (current_digit + 1) % 4;
+    if(!on && !off) {
+        return -1;
+    }
+    tenths = on;
+    sched_post(&save_task);
+    if(tenths) {
+        sched_every(&display_task, TENTHS_MS);
+    } else {
+        sched_stop(&display_task);
+    }
+    redraw();
+    return 0;
+}
+
+// standby (needs a running channel to wake up)
+int cmd_standby(uint8_t argc, char *argv[]) {
+    (void)argv;
+    if(argc != 1 || countdown_suspend(standby_alarm) == 0) {
+        return -1;
+    }
+    display_enable(false);
+    standby = true;  // Sleeps once the reply is out
+    store_flush();   // Nothing pending while asleep, display stays dark
+    return 0;
 }
 
-uint8_t read_button(uint8_t pin, uint8_t *prev_state) {
-    uint8_t current = !gpio_read(pin);  // Active low
-    uint8_t pressed = 0;
+int cmd_stats(uint8_t argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    uart_num_t uart = console_uart();
     
-    if(current && !(*prev_state)) {
-        pressed = 1;
-        delay_ms(50);  // Debounce
+    uart_printf(uart, "uptime %u ms, showing channel %u\r\n", millis(), shown + 1);
+    for(uint8_t ch = 0; ch < COUNTDOWN_CHANNELS; ch++) {
+        mmss_t value = countdown_value(ch);
+        uart_printf(uart, "channel %u: state %d, time %d%d:%d%d\r\n", ch + 1, countdown_state(ch),
+                    value.digit[0], value.digit[1], value.digit[2], value.digit[3]);
     }
+    uart_printf(uart, "dropped: events %u, frames %u\r\n", event_dropped(), frame_dropped());
     
-    *prev_state = current;
-    return pressed;
+    for(sched_task_t *t = sched_tasks(); t; t = t->next) {
+        uart_printf(uart, "task prio %u: runs %u, misses %u, max latency %u us\r\n",
+                    t->priority, t->runs, t->misses, t->max_latency_us);
+    }
+    diag_dump(uart);
+    profile_dump(uart);
+    return 0;
 }
 
-void timer_update(void) {
-    uint32_t current_time = millis();
+static const console_cmd_t commands[] = {
+    { "set",   "MM:SS [ch]  set the countdown time",  cmd_set   },
+    { "start", "[ch]  start or resume the countdown", cmd_start },
+    { "pause", "[ch]  pause the countdown",           cmd_pause },
+    { "reset", "[ch]  stop and reload the set time",  cmd_reset },
+    { "show",  "ch|auto  select or page the display", cmd_show  },
+    { "tenths", "on|off  tenths in the last minute",  cmd_tenths },
+    { "standby", "sleep until the next expiry",       cmd_standby },
+    { "stats", "uptime, drops, tasks, stack, IRQs",   cmd_stats }
+};
+
+void process_events(void *arg) {
+    (void)arg;
+    PROFILE_ENTER(process_events);
+    event_t event;
     
-    if(state == STATE_RUNNING && (current_time - last_tick >= 1000)) {
-        last_tick = current_time;
-        
-        if(timer_value > 0) {
-            timer_value--;
-        } else {
-            state = STATE_DONE;
+    while(event_get(&event)) {
+        switch(event.type) {
+            case EVENT_BUTTON:
+                telemetry_button(event.id, event.value);
+                if(event.value == INPUT_PRESS && event.id < BUTTON_COUNT) {
+                    countdown_dispatch(shown, (countdown_event_t)button_events[event.id], 0);
+                }
+                break;
+            
+            case EVENT_UART_RX:
+                console_poll();
+                break;
+            
+            default:
+                break;
         }
     }
+    PROFILE_EXIT(process_events);
 }
 
-void process_buttons(void) {
-    // Countdown mode button
-    if(read_button(BTN_COUNTDOWN, &btn_countdown_prev)) {
-        if(state == STATE_SET) {
-            timer_value = set_value;
-        }
+void wake_input_task(void) {
+    sched_post(&input_task);
+}
+
+// Countdown change hook, only the channel on the display needs a redraw
+void countdown_changed(uint8_t channel) {
+    if(channel == shown) {
+        sched_post(&display_task);
     }
+    sched_post(&save_task);
+}
+
+// Cheap on every change: ticks leave the snapshot alone, the store ignores
+// repeats and batches the writes
+void save_state(void *arg) {
+    (void)arg;
+    static saved_t saved;  // Static: padding stays zero for the compare
     
-    // Set button (increment time in set mode)
-    if(read_button(BTN_SET, &btn_set_prev)) {
-        if(state == STATE_SET) {
-            set_value += 10;
-            if(set_value > 5999) set_value = 10;  // Max 99:59
-            timer_value = set_value;
-        }
+    saved.version = SAVED_VERSION;
+    saved.tenths = tenths;
+    countdown_snapshot(&saved.countdown);
+    store_save(&saved, sizeof(saved));
+}
+
+// Store busy hook: a digit would stay lit while the flash holds the
+// refresh interrupt, keep the display dark instead (~1 ms, 100 ms erases)
+void flash_busy(bool busy) {
+    if(!standby) {
+        display_enable(!busy);
     }
+}
+
+void load_state(void) {
+    saved_t saved;
     
-    // Start/Pause button
-    if(read_button(BTN_START, &btn_start_prev)) {
-        if(state == STATE_SET) {
-            state = STATE_RUNNING;
-            timer_value = set_value;
-            last_tick = millis();
-        } else if(state == STATE_RUNNING) {
-            state = STATE_PAUSED;
-        } else if(state == STATE_PAUSED) {
-            state = STATE_RUNNING;
-            last_tick = millis();
-        } else if(state == STATE_DONE) {
-            state = STATE_SET;
-            timer_value = set_value;
-        }
+    if(store_load(&saved, sizeof(saved)) != sizeof(saved) || saved.version != SAVED_VERSION) {
+        return;  // First boot or old layout: defaults
+    }
+    tenths = saved.tenths;
+    if(tenths) {
+        sched_every(&display_task, TENTHS_MS);
+    }
+    countdown_restore(&saved.countdown);
+}
+
+void display_update(void *arg) {
+    (void)arg;
+    mmss_t value = countdown_value(shown);
+    bool changed = (value.word != shown_value);
+    uint8_t t;
+    mmss_t fine = countdown_value_tenths(shown, &t);
+    
+    shown_value = value.word;
+    
+    if(banner) {
+        const uint8_t digits[DISPLAY_DIGITS] = {
+            SEG_LETTER_C, DISPLAY_BLANK, DISPLAY_BLANK, display_encode_digit((shown + 1) % 10)
+        };
+        display_write(digits);
+    } else if(tenths && fine.digit[0] == 0 && fine.digit[1] == 0) {
+        const uint8_t digits[DISPLAY_DIGITS] = { 0xFF, fine.digit[2], fine.digit[3], t };
+        display_show_digits(digits, 0x04);  // " SS.t", 0xFF is blank
+    } else if(changed) {
+        // Refresh runs from PWM1, only touch the framebuffer on change
+        display_show_digits(value.digit, 0x02);  // DP after second digit (MM:SS)
     }
     
-    // Reset button
-    if(read_button(BTN_RESET, &btn_reset_prev)) {
-        state = STATE_SET;
-        timer_value = set_value;
+    if(changed) {
+        telemetry_time(shown, value.digit);
     }
 }
 
-uint16_t format_time_mmss(uint32_t seconds) {
-    uint32_t minutes = seconds / 60;
-    uint32_t secs = seconds % 60;
-    return (minutes * 100) + secs;
+void telemetry_report(void *arg) {
+    (void)arg;
+    for(uint8_t ch = 0; ch < COUNTDOWN_CHANNELS; ch++) {
+        telemetry_status(ch, countdown_state(ch), countdown_value(ch).digit);
+    }
 }
 
 int main(void) {
-    systick_init(12000000);  // 12MHz
+    diag_init();              // Paint the stack before anything uses it
+    clock_set_cpu(12000000);  // Crystal, PLL0 off: plenty for counting
+    systick_init();
     gpio_init();
+    event_init();
+    swtimer_init();
+    rtc_init();
     
-    display_init();
-    buttons_init();
+    display_init(&DISPLAY_DRIVER);
+    input_init();
+    telemetry_init();
+    console_init(TELEMETRY_UART, commands, sizeof(commands) / sizeof(commands[0]));  // Replies in TLM_MSG_TEXT
     
-    timer_value = set_value;
+    // Deadlines are release-to-start budgets in ms
+    sched_add(&input_task, process_events, 0, PRIO_INPUT, INPUT_SCAN_MS);
+    sched_add(&wake_task, standby_exit, 0, PRIO_INPUT, SCHED_NO_DEADLINE);
+    sched_add(&display_task, display_update, 0, PRIO_DISPLAY, 20);
+    sched_add(&page_task, page_next, 0, PRIO_DISPLAY, SCHED_NO_DEADLINE);
+    sched_add(&telemetry_task, telemetry_report, 0, PRIO_TELEMETRY, SCHED_NO_DEADLINE);
+    sched_every(&telemetry_task, TELEMETRY_PERIOD_MS);
+    sched_add(&save_task, save_state, 0, PRIO_SAVE, SCHED_NO_DEADLINE);
+    event_set_notify(wake_input_task);
+    sched_set_idle(idle);
     
-    while(1) {
-        process_buttons();
-        timer_update();
-        
-        uint16_t display_val = format_time_mmss(timer_value);
-        display_number(display_val);
-        
-        delay_us(2000);  // Multiplex delay
-    }
+    swtimer_setup(&banner_timer, banner_done, 0, SWTIMER_DEFERRED);
+    countdown_init(PRIO_TICK, countdown_changed);  // Set mode, shows the set time
+    store_init();  // Latest record in O(log pages) reads
+    store_attach(flash_busy);
+    load_state();
+    
+    sched_run();  // Sleeps in systick_idle() whenever no task is released
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,61 @@
+/**
+ * @file telemetry.c
+ * @brief Binary telemetry of the countdown timer implementation
+ */
+
+#include "telemetry.h"
+#include "frame.h"
+#include "systick.h"
+#include "event.h"
+
+/* ==================== Helper Functions ==================== */
+
+// Two BCD digits per byte, tens in the high nibble
+static uint8_t pack_bcd(uint8_t tens, uint8_t ones) {
+    return (uint8_t)((tens << 4) | ones);
+}
+
+/* ==================== Public Functions ==================== */
+
+void telemetry_init(void) {
+    uart_init(TELEMETRY_UART, TELEMETRY_BAUD);
+    frame_text_attach(TELEMETRY_UART, TLM_MSG_TEXT);  // Console replies
+}
+
+void telemetry_state(uint8_t channel, uint8_t state) {
+    uint8_t msg[2] = { channel, state };
+
+    frame_send(TELEMETRY_UART, TLM_MSG_STATE, msg, sizeof(msg));
+}
+
+void telemetry_time(uint8_t channel, const uint8_t bcd[4]) {
+    uint8_t msg[3] = { channel, pack_bcd(bcd[0], bcd[1]), pack_bcd(bcd[2], bcd[3]) };
+
+    frame_send(TELEMETRY_UART, TLM_MSG_TIME, msg, sizeof(msg));
+}
+
+void telemetry_button(uint8_t button, uint8_t type) {
+    uint8_t msg[2] = { button, type };
+
+    frame_send(TELEMETRY_UART, TLM_MSG_BUTTON, msg, sizeof(msg));
+}
+
+void telemetry_status(uint8_t channel, uint8_t state, const uint8_t bcd[4]) {
+    uint32_t uptime = millis();
+    uint32_t dropped = frame_dropped() + event_dropped();
+    uint16_t dropped16 = (dropped > 0xFFFF) ? 0xFFFF : (uint16_t)dropped;  // Saturate
+    uint8_t msg[10];
+
+    msg[0] = channel;
+    msg[1] = state;
+    msg[2] = pack_bcd(bcd[0], bcd[1]);
+    msg[3] = pack_bcd(bcd[2], bcd[3]);
+    msg[4] = uptime & 0xFF;
+    msg[5] = (uptime >> 8) & 0xFF;
+    msg[6] = (uptime >> 16) & 0xFF;
+    msg[7] = uptime >> 24;
+    msg[8] = dropped16 & 0xFF;
+    msg[9] = dropped16 >> 8;
+
+    frame_send(TELEMETRY_UART, TLM_MSG_STATUS, msg, sizeof(msg));
+}
@@ -0,0 +1,76 @@
+/**
+ * @file telemetry.h
+ * @brief Binary telemetry of the countdown timer over UART
+ * @note Messages are hal/frame frames (COBS + CRC-16), all queued
+ *       non-blocking from the main loop. Multi-byte fields are little-endian.
+ *       The console shares the port: its replies arrive as TLM_MSG_TEXT
+ *       frames, its commands are sent as plain text lines.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "uart.h"
+
+/* ==================== Configuration ==================== */
+// UART2 (P0.10/P0.11): the other UARTs share pins with the display
+#ifndef TELEMETRY_UART
+#define TELEMETRY_UART       UART_2
+#endif
+
+#ifndef TELEMETRY_BAUD
+#define TELEMETRY_BAUD       115200
+#endif
+
+// Status report interval of the telemetry task
+#ifndef TELEMETRY_PERIOD_MS
+#define TELEMETRY_PERIOD_MS  1000
+#endif
+
+/* ==================== Message IDs ==================== */
+typedef enum {
+    TLM_MSG_STATE  = 0x01,  // [channel, state]
+    TLM_MSG_TIME   = 0x02,  // [channel, mm_bcd, ss_bcd]
+    TLM_MSG_BUTTON = 0x03,  // [button, input_event_type_t]
+    TLM_MSG_STATUS = 0x04,  // [channel, state, mm_bcd, ss_bcd, uptime_ms:u32, dropped:u16]
+    TLM_MSG_TEXT   = 0x05   // [ASCII...] console output, a line or part of one
+} tlm_msg_t;
+
+/* ==================== Functions ==================== */
+
+/**
+ * @brief Open the telemetry UART, its text output goes out as TLM_MSG_TEXT
+ */
+void telemetry_init(void);
+
+/**
+ * @brief Report a state transition
+ * @param channel Countdown channel
+ * @param state New timer_state_t value
+ */
+void telemetry_state(uint8_t channel, uint8_t state);
+
+/**
+ * @brief Report the displayed time
+ * @param channel Countdown channel being shown
+ * @param bcd MM:SS digits, bcd[0] = tens of minutes
+ */
+void telemetry_time(uint8_t channel, const uint8_t bcd[4]);
+
+/**
+ * @brief Report a button event
+ * @param button button_t
+ * @param type input_event_type_t
+ */
+void telemetry_button(uint8_t button, uint8_t type);
+
+/**
+ * @brief Send a full status report of one channel (periodic heartbeat)
+ * @param channel Countdown channel
+ * @param state Current timer_state_t value
+ * @param bcd Current MM:SS digits
+ */
+void telemetry_status(uint8_t channel, uint8_t state, const uint8_t bcd[4]);
+
+#endif // TELEMETRY_H